@@ -0,0 +1,56 @@
+#include "Arena.h"
+#include <cstdint>
+
+using namespace std;
+
+/*
+	The Source file of the class "Arena".
+*/
+
+Arena::Arena(size_t block_size) {
+
+	/* Arena constructor : the first block is allocated by the first object. */
+
+	blockSize = block_size > 0 ? block_size : 1;
+}
+
+Arena::~Arena() {
+	reset();
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+
+	/* Bump allocation in the last regular block : a new block is started when the object does not fit. */
+
+	size_t padding = (alignment - (uintptr_t)current % alignment) % alignment;
+	if (!current || padding + size > remaining) {
+		if (size + alignment > blockSize) {
+			// Large object : a block of its own, the current block keeps its free space
+			largeBlocks.emplace_back(new char[size + alignment]);
+			char* block = largeBlocks.back().get();
+			used += size;
+			return block + (alignment - (uintptr_t)block % alignment) % alignment;
+		}
+		blocks.emplace_back(new char[blockSize]);
+		current = blocks.back().get();
+		remaining = blockSize;
+		padding = (alignment - (uintptr_t)current % alignment) % alignment;
+	}
+	void* p = current + padding;
+	current += padding + size;
+	remaining -= padding + size;
+	used += size;
+	return p;
+}
+
+void Arena::reset() {
+	for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+		it->second(it->first);
+	destructors.clear();
+	largeBlocks.clear();
+	if (blocks.size() > 1)
+		blocks.resize(1);
+	current = blocks.empty() ? nullptr : blocks[0].get();
+	remaining = blocks.empty() ? 0 : blockSize;
+	used = 0;
+}
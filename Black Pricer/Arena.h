@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+/*
+	The Header file of the class "Arena".
+	The "Arena" owns the Options and the models of a book : they are placed one after the other in large blocks, and all freed at once
+	when the Arena is destroyed (or reset). Building and tearing down a book costs a few block allocations instead of one per object.
+	The objects with a non-trivial destructor (the multi-asset models and their vectors) are destroyed by the Arena, in reverse order.
+*/
+
+class Arena {
+private :
+	vector<unique_ptr<char[]>> blocks;
+	vector<unique_ptr<char[]>> largeBlocks; // Objects larger than a regular block.
+	size_t blockSize; // Size of the regular blocks.
+	char* current = nullptr; // Free space of the last regular block.
+	size_t remaining = 0;
+	size_t used = 0; // Bytes given to the objects.
+	vector<pair<void*, void (*)(void*)>> destructors;
+public :
+	Arena(size_t block_size = 1 << 20);
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena();
+	void* allocate(size_t size, size_t alignment); // Raw aligned memory, valid until the Arena is reset or destroyed.
+	template <typename T, typename... Args> T* create(Args&&... args) {
+		T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!is_trivially_destructible<T>::value)
+			destructors.emplace_back(object, [](void* p) { ((T*)p)->~T(); });
+		return object;
+	}; // Builds a "T" in the Arena, e.g. arena.create<VanillaOption>(105, 1, 1).
+	void reset(); // Destroys every object, and keeps the first block for the next book.
+	size_t getUsed() { return used; };
+	size_t getNbBlocks() { return blocks.size() + largeBlocks.size(); };
+};
@@ -0,0 +1,171 @@
+#include "BatchPricer.h"
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <cstring>
+
+using namespace std;
+
+/*
+	The Source file of the class "BatchPricer".
+*/
+
+BatchPricer::BatchPricer(int nb_threads, int chunk_size, int nb_chunks) {
+
+	/* Batch pricer constructor. 0 selects the default number of threads or chunks. */
+
+	nbThreads = nb_threads > 0 ? nb_threads : max(1, (int)thread::hardware_concurrency());
+	chunkSize = max(1, chunk_size);
+	nbChunks = nb_chunks > 0 ? nb_chunks : 4 * nbThreads;
+}
+
+bool BatchPricer::readChunk(istream& in, TradeChunk& chunk) {
+	/*
+		Binary input : "chunkSize" records are read at once. A truncated last record is dropped.
+		CSV input : "chunkSize" complete lines are appended to the chunk buffer, whose capacity is kept between the runs of the chunk.
+	*/
+	chunk.input.clear();
+	if (inputFormat == FORMAT_BINARY) {
+		chunk.input.resize((size_t)chunkSize * sizeof(TradeRecord));
+		in.read(&chunk.input[0], chunk.input.size());
+		chunk.input.resize((size_t)in.gcount() / sizeof(TradeRecord) * sizeof(TradeRecord));
+		return !chunk.input.empty();
+	}
+
+	string line;
+	for (int i = 0; i < chunkSize && getline(in, line); i++) {
+		chunk.input += line;
+		chunk.input += '\n';
+	}
+	return !chunk.input.empty();
+}
+
+void BatchPricer::processChunk(TradeChunk& chunk, MonteCarlo& mc) {
+
+	/* The three stages of a chunk on a pricing thread : parse, price, and serialize. */
+
+	// Parse : the results receive the parsing status of their trade
+	chunk.trades.clear();
+	chunk.results.clear();
+	if (inputFormat == FORMAT_BINARY) {
+		chunk.trades.resize(chunk.input.size() / sizeof(TradeRecord));
+		memcpy(chunk.trades.data(), chunk.input.data(), chunk.trades.size() * sizeof(TradeRecord));
+		chunk.results.resize(chunk.trades.size());
+	}
+	else {
+		const char* line = chunk.input.data();
+		const char* input_end = line + chunk.input.size();
+		while (line < input_end) {
+			const char* line_end = (const char*)memchr(line, '\n', input_end - line);
+			if (!isTradeCSVComment(line, line_end)) {
+				TradeRecord trade;
+				ResultRecord result;
+				result.status = parseTradeCSV(line, line_end, trade);
+				chunk.trades.push_back(trade);
+				chunk.results.push_back(result);
+			}
+			line = line_end + 1;
+		}
+	}
+
+	// Price
+	for (size_t i = 0; i < chunk.trades.size(); i++) {
+		ResultRecord& result = chunk.results[i];
+		result.id = chunk.trades[i].id;
+		if (result.status == TRADE_OK)
+			result.status = convertOnly ? validateTrade(chunk.trades[i]) : priceTrade(chunk.trades[i], mc, result.price);
+	}
+
+	// Serialize
+	chunk.output.clear();
+	chunk.errors = 0;
+	for (const ResultRecord& result : chunk.results)
+		chunk.errors += result.status != TRADE_OK;
+	if (convertOnly) {
+		for (size_t i = 0; i < chunk.trades.size(); i++)
+			if (chunk.results[i].status == TRADE_OK)
+				chunk.output.append((const char*)&chunk.trades[i], sizeof(TradeRecord));
+	}
+	else if (outputFormat == FORMAT_BINARY)
+		chunk.output.append((const char*)chunk.results.data(), chunk.results.size() * sizeof(ResultRecord));
+	else
+		for (const ResultRecord& result : chunk.results)
+			appendResultCSV(result, chunk.output);
+}
+
+BatchStats BatchPricer::run(istream& in, ostream& out) {
+	/*
+		Pipeline of the batch :
+			reader thread : takes a free chunk from the pool, and fills it with raw input ;
+			pricing threads : parse, price and serialize the chunks of the work queue ;
+			calling thread : writes the priced chunks in input order, and gives them back to the pool.
+		The chunks in flight never exceed "nbChunks", so the reader waits for the writer when the pricing or the output is slower than the input.
+	*/
+	auto start = chrono::steady_clock::now();
+	BatchStats stats;
+	ostream* tied = in.tie(nullptr); // The reader thread must not flush "out" (cin is tied to cout).
+
+	vector<TradeChunk> chunks(nbChunks);
+	BoundedQueue<TradeChunk*> free_chunks(nbChunks);
+	BoundedQueue<TradeChunk*> work_queue(nbChunks);
+	BoundedQueue<TradeChunk*> done_queue(nbChunks);
+	for (TradeChunk& chunk : chunks)
+		free_chunks.push(&chunk);
+
+	if (outputFormat == FORMAT_CSV && !convertOnly)
+		out << RESULT_CSV_HEADER << '\n';
+
+	thread reader([&] {
+		uint64_t sequence = 0;
+		TradeChunk* chunk;
+		while (free_chunks.pop(chunk)) {
+			if (!readChunk(in, *chunk))
+				break;
+			chunk->sequence = sequence++;
+			work_queue.push(chunk);
+		}
+		work_queue.close();
+	});
+
+	atomic<int> running(nbThreads);
+	vector<thread> workers;
+	for (int t = 0; t < nbThreads; t++) {
+		workers.emplace_back([&] {
+			MonteCarlo mc;
+			TradeChunk* chunk;
+			while (work_queue.pop(chunk)) {
+				processChunk(*chunk, mc);
+				done_queue.push(chunk);
+			}
+			if (--running == 0)
+				done_queue.close();
+		});
+	}
+
+	// Writer : the chunks may be priced out of order, and wait in "pending" until their predecessors are written
+	map<uint64_t, TradeChunk*> pending;
+	uint64_t next = 0;
+	TradeChunk* chunk;
+	while (done_queue.pop(chunk)) {
+		pending[chunk->sequence] = chunk;
+		while (!pending.empty() && pending.begin()->first == next) {
+			TradeChunk* ready = pending.begin()->second;
+			pending.erase(pending.begin());
+			out.write(ready->output.data(), ready->output.size());
+			stats.trades += ready->trades.size();
+			stats.errors += ready->errors;
+			stats.chunks++;
+			next++;
+			free_chunks.push(ready);
+		}
+	}
+
+	reader.join();
+	for (thread& worker : workers)
+		worker.join();
+	out.flush();
+	in.tie(tied);
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return stats;
+}
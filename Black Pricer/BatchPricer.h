@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <istream>
+#include <ostream>
+#include "Trade.h"
+
+using namespace std;
+
+/*
+	The Header file of the class "BatchPricer".
+	The "BatchPricer" streams trades from an input stream (CSV lines or binary "TradeRecord"s) to an output stream (CSV lines or binary "ResultRecord"s).
+	The trades go through a pipeline of chunks : a reader thread fills the chunks with raw input, the worker threads parse, price and serialize them,
+	and the calling thread writes them in input order. The chunks are recycled through a fixed pool, so the memory does not depend on the input size.
+*/
+
+template <typename T>
+class BoundedQueue {
+	/* Blocking FIFO queue of at most "capacity" items. "close" wakes up the consumers once the queue is drained. */
+private :
+	deque<T> items;
+	size_t capacity;
+	bool closed = false;
+	mutex m;
+	condition_variable not_empty;
+	condition_variable not_full;
+public :
+	BoundedQueue(size_t max_size) : capacity(max_size) {};
+	void push(T item) {
+		unique_lock<mutex> lock(m);
+		not_full.wait(lock, [this] { return items.size() < capacity; });
+		items.push_back(move(item));
+		not_empty.notify_one();
+	};
+	bool pop(T& item) {
+		unique_lock<mutex> lock(m);
+		not_empty.wait(lock, [this] { return !items.empty() || closed; });
+		if (items.empty())
+			return false;
+		item = move(items.front());
+		items.pop_front();
+		not_full.notify_one();
+		return true;
+	};
+	void close() {
+		lock_guard<mutex> lock(m);
+		closed = true;
+		not_empty.notify_all();
+	};
+};
+
+enum BatchFormat { FORMAT_CSV, FORMAT_BINARY };
+
+struct TradeChunk {
+	uint64_t sequence = 0; // Position of the chunk in the input.
+	string input; // Raw input : complete CSV lines, or binary "TradeRecord"s.
+	vector<TradeRecord> trades;
+	vector<ResultRecord> results;
+	uint64_t errors = 0; // Number of results whose status is not TRADE_OK.
+	string output; // Serialized results (or serialized trades for the conversions).
+};
+
+struct BatchStats {
+	uint64_t trades = 0; // Number of trades read.
+	uint64_t errors = 0; // Number of trades that were not priced (not converted for the conversions).
+	uint64_t chunks = 0;
+	double seconds = 0; // Wall-clock time of the run.
+};
+
+class BatchPricer {
+private :
+	int nbThreads; // Number of pricing threads. Default : the number of hardware threads.
+	int chunkSize; // Number of trades per chunk. Default : 256.
+	int nbChunks; // Number of chunks in flight, which bounds the memory. Default : 4 per pricing thread.
+	BatchFormat inputFormat = FORMAT_CSV;
+	BatchFormat outputFormat = FORMAT_CSV;
+	bool convertOnly = false; // Writes the valid trades as binary "TradeRecord"s instead of pricing them.
+	bool readChunk(istream& in, TradeChunk& chunk); // Reads the raw input of the next chunk, returns false at the end of the input.
+	void processChunk(TradeChunk& chunk, MonteCarlo& mc); // Parses, prices and serializes a chunk.
+public :
+	BatchPricer(int nb_threads = 0, int chunk_size = 256, int nb_chunks = 0);
+	void setNbThreads(int threads) { nbThreads = threads; };
+	int getNbThreads() { return nbThreads; };
+	void setChunkSize(int size) { chunkSize = size; };
+	int getChunkSize() { return chunkSize; };
+	void setNbChunks(int chunks) { nbChunks = chunks; };
+	int getNbChunks() { return nbChunks; };
+	void setInputFormat(BatchFormat format) { inputFormat = format; };
+	BatchFormat getInputFormat() { return inputFormat; };
+	void setOutputFormat(BatchFormat format) { outputFormat = format; };
+	BatchFormat getOutputFormat() { return outputFormat; };
+	void setConvertOnly(bool convert) { convertOnly = convert; };
+	bool getConvertOnly() { return convertOnly; };
+	BatchStats run(istream& in, ostream& out); // Prices every trade of "in" and writes the results to "out", in input order.
+};
@@ -1,6 +1,8 @@
 #include "BlackScholesModel.h"
+#include "Numerics.h"
 #include <cmath>
 #include <algorithm>
+#include <cctype>
 #include <numeric> 
 #include <iostream>
 
@@ -10,19 +12,29 @@ using namespace std;
 	The Source file of the class "BlackScholesModel".
 */
 
-double std_normal_cum(double x) {
+double BlackScholesModel::simulation(double prev_S, double dt, double rnd_normal) {
 	
-	/* Standard Normal Distribution Cumulative function. */
+	/* Spot price simulation between t and t + dt under the BS model. */
+
+	return simulation(prev_S, dt, pow(dt, 0.5), rnd_normal);
 
-	return 0.5 + 0.5 * erf(x / pow(2, 0.5));
 }
 
-double BlackScholesModel::simulation(double prev_S, double dt, double rnd_normal) {
-	
-	/* Spot price simulation between t and t + dt under the BS model. */
+double BlackScholesModel::simulation(double prev_S, double dt, double sqrt_dt, double rnd_normal) {
 
-	return prev_S * exp((r - pow(sigma, 2) / 2) * dt + sigma * pow(dt, 0.5) * rnd_normal);
+	/* Spot price simulation between t and t + dt under the BS model, with sqrt(dt) given. */
 
+	return prev_S * exp((r - sigma * sigma / 2) * dt + sigma * sqrt_dt * rnd_normal);
+}
+
+void BlackScholesModel::simulation(float* S_t, const float* rnd_normal, int n, double dt, double sqrt_dt) {
+
+	/* Single precision simulation of n spot prices between t and t + dt : the drift and the diffusion of the step are computed once, in double. */
+
+	float drift = (float)((r - sigma * sigma / 2) * dt);
+	float diffusion = (float)(sigma * sqrt_dt);
+	for (int j = 0; j < n; j++)
+		S_t[j] *= exp(drift + diffusion * rnd_normal[j]);
 }
 
 BlackVanilla::BlackVanilla(double rate, double spot, double vol) {
@@ -38,14 +50,18 @@ double BlackVanilla::price(Option* opt) {
 	
 	/* BS Vanilla price. */
 
-	double T = opt->getMaturity();
-	double K = opt->getStrike();
+	return price(opt->getStrike(), opt->getMaturity(), opt->getPhi());
+}
+
+double BlackVanilla::price(double K, double T, int phi) {
+
+	/* BS Vanilla price of the contract terms. */
+
 	double df = exp(-r * T);
 	double fwd = S / df;
 	double v2T = pow(sigma, 2) * T;
 	double d1 = (log(fwd / K) + v2T / 2) / pow(v2T, 0.5);
 	double d2 = d1 - pow(v2T, 0.5);
-	double phi = opt->getPhi();
 	return phi * S * std_normal_cum(phi * d1) - phi * K * df * std_normal_cum(phi * d2);
 }
 
@@ -62,14 +78,18 @@ double BlackDigital::price(Option* opt) {
 	
 	/* BS Digital price. */
 
-	double T = opt->getMaturity();
-	double K = opt->getStrike();
+	return price(opt->getStrike(), opt->getMaturity(), opt->getPhi());
+}
+
+double BlackDigital::price(double K, double T, int phi) {
+
+	/* BS Digital price of the contract terms. */
+
 	double df = exp(-r * T);
 	double fwd = S / df;
 	double v2T = pow(sigma, 2) * T;
 	double d1 = (log(fwd / K) + v2T / 2) / pow(v2T, 0.5);
 	double d2 = d1 - pow(v2T, 0.5);
-	double phi = opt->getPhi();
 	return df * std_normal_cum(phi * d2);
 }
 
@@ -84,40 +104,39 @@ BlackBarrier::BlackBarrier(double rate, double spot, double vol) {
 
 double BlackBarrier::price(Option* opt) {
 	
-	/* BS Barrier price : Barrier Static Replication using Vanilla and Digital Options */
+	/* BS Barrier price of the Option : the barrier type decides between the knock-out and the knock-in prices. */
 
-	double barrier = opt->getBarrier();
-	double strike = opt->getStrike();
-	double maturity = opt->getMaturity();
-	double phi = opt->getPhi();
 	string type = opt->getType();
-
-	VanillaOption* vanilla_strike = new VanillaOption(strike, maturity, phi);
-	VanillaOption* vanilla_barrier = new VanillaOption(barrier, maturity, phi);
-	DigitalOption* digital_barrier = new DigitalOption(barrier, maturity, phi);
-
-	BlackVanilla bs_vanilla(r, S, sigma);
-	BlackDigital bs_digital(r, S, sigma);
-
-	double vanilla_strike_price = bs_vanilla.price(vanilla_strike);
-	double vanilla_barrier_price = bs_vanilla.price(vanilla_barrier);
-	double digital_barrier_price = bs_digital.price(digital_barrier);
-
-	double price_out = vanilla_strike_price - vanilla_barrier_price - phi * (barrier - strike) * digital_barrier_price;
+	double phi = opt->getPhi();
 
 	// Remove the spaces from the string type and switch it to upper cases
-	type.erase(remove_if(type.begin(), type.end(), isspace), type.end());
+	type.erase(remove_if(type.begin(), type.end(), ::isspace), type.end());
 	for (char& c : type) c = toupper(c);
 	
 	if ((type == "UPOUT" && phi == 1) || (type == "DOWNOUT" && phi == -1))
-		return price_out;
+		return price(opt->getStrike(), opt->getBarrier(), opt->getMaturity(), phi, false);
 	if ((type == "UPIN" && phi == 1) || (type == "DOWNIN" && phi == -1))
-		return vanilla_strike_price - price_out;
+		return price(opt->getStrike(), opt->getBarrier(), opt->getMaturity(), phi, true);
 
 	cout << "Unknow Barrier Option Type. The possible types are : \"Up Out\" and \"Up In\" for Calls, and \"Down Out\" and \"Down In\" for Puts." << endl;
 	exit(-1);
 }
 
+double BlackBarrier::price(double K, double B, double T, int phi, bool knock_in) {
+
+	/* BS Barrier price : Barrier Static Replication using Vanilla and Digital Options */
+
+	BlackVanilla bs_vanilla(r, S, sigma);
+	BlackDigital bs_digital(r, S, sigma);
+
+	double vanilla_strike_price = bs_vanilla.price(K, T, phi);
+	double vanilla_barrier_price = bs_vanilla.price(B, T, phi);
+	double digital_barrier_price = bs_digital.price(B, T, phi);
+
+	double price_out = vanilla_strike_price - vanilla_barrier_price - phi * (B - K) * digital_barrier_price;
+	return knock_in ? vanilla_strike_price - price_out : price_out;
+}
+
 
 BlackAsian::BlackAsian(double rate, double spot, double vol) {
 	
@@ -130,33 +149,27 @@ BlackAsian::BlackAsian(double rate, double spot, double vol) {
 
 double BlackAsian::price(Option* opt) {
 	
-	/* BS Asian price : BS formula based on the moments matching method of the arithmetic average. */
+	/* BS Asian price of the Option. */
 
-	double freq = opt->getFreq();
-	double T = opt->getMaturity();
-	double K = opt->getStrike();
-	vector<double> betas;
-	vector<double> e_v2T;
-
-	for (int i = 1; i <= freq; i++) {
-		betas.push_back(S * exp(r * i * T / freq) / freq);
-		e_v2T.push_back(exp(pow(sigma, 2) * i * T / freq));
-	}
+	return price(opt->getStrike(), opt->getMaturity(), opt->getPhi(), opt->getFreq());
+}
 
-	double m1 = accumulate(betas.begin(), betas.end(), 0.);
+double BlackAsian::price(double K, double T, int phi, double freq) {
+	/*
+		BS Asian price : BS formula based on the moments matching method of the arithmetic average.
+		With beta_i = S exp(r t_i) / freq, m1 = sum(beta_i) and m2 = sum(beta_i exp(sigma^2 t_i) (2 sum_(j >= i) beta_j - beta_i)) :
+		the inner sums are the suffix sums of the betas, accumulated from the last fixing, so the moments cost O(freq).
+	*/
+	double m1 = 0; // Suffix sum of the betas, from the fixing i to the last one : m1 once the loop ends.
 	double m2 = 0;
-	double temp = 0;
-
-	for (int i = 0; i < freq; i++) {
-		for (int j = i; j < freq; j++)
-			temp += 2 * betas[j];
-		m2 += betas[i] * e_v2T[i] * (temp - betas[i]);
-		temp = 0;
+	for (int i = (int)freq; i >= 1; i--) {
+		double beta = S * exp(r * i * T / freq) / freq;
+		m1 += beta;
+		m2 += beta * exp(pow(sigma, 2) * i * T / freq) * (2 * m1 - beta);
 	}
 
 	double df = exp(-r * T);
 	double d1 = (log(m1 / K) + log(m2 / pow(m1, 2)) / 2) / pow(log(m2 / pow(m1, 2)), 0.5);
 	double d2 = d1 - pow(log(m2 / pow(m1, 2)), 0.5);
-	double phi = opt->getPhi();
 	return df * (phi * m1 * std_normal_cum(phi * d1) - phi * K * std_normal_cum(phi * d2));
 }
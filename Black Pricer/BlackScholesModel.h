@@ -20,6 +20,8 @@ public :
 	void setSpot(double spot) { S = spot; };
 	double getSpot() { return S; };
 	double simulation(double prev_S, double dt, double rnd_normal); // The simulation method is called in the "MonteCarlo" class.
+	double simulation(double prev_S, double dt, double sqrt_dt, double rnd_normal); // Same simulation, with the square root of the time step precomputed by the "Schedule".
+	void simulation(float* S_t, const float* rnd_normal, int n, double dt, double sqrt_dt); // Single precision simulation of n paths over the same time step : S_t is updated in place.
 	virtual double price(Option* opt) = 0; // The BS price is a pure virtual method.
 };
 
@@ -27,23 +29,27 @@ class BlackVanilla : public BlackScholesModel {
 public :
 	BlackVanilla(double rate, double spot, double vol);
 	double price(Option* opt);
+	double price(double K, double T, int phi); // Price of the contract terms, without an Option.
 };
 
 class BlackDigital : public BlackScholesModel {
 public:
 	BlackDigital(double rate, double spot, double vol);
 	double price(Option* opt);
+	double price(double K, double T, int phi); // Price of the contract terms, without an Option.
 };
 
 class BlackBarrier : public BlackScholesModel {
 public:
 	BlackBarrier(double rate, double spot, double vol);
 	double price(Option* opt);
+	double price(double K, double B, double T, int phi, bool knock_in); // Price of the contract terms : "Up Out" / "Down Out" for knock_in = false, "Up In" / "Down In" for knock_in = true.
 };
 
 class BlackAsian : public BlackScholesModel {
 public:
 	BlackAsian(double rate, double spot, double vol);
 	double price(Option* opt);
+	double price(double K, double T, int phi, double freq); // Price of the contract terms, without an Option.
 };
 
@@ -0,0 +1,171 @@
+#include "HestonModel.h"
+#include "Numerics.h"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/*
+	The Source file of the class "HestonModel".
+*/
+
+HestonModel::HestonModel(double rate, double spot, double initial_var, double mean_reversion, double long_term_var, double vol_of_var, double corr) {
+
+	/* Heston constructor : the variances must be non-negative and the correlation in [-1, 1]. */
+
+	if (!(initial_var >= 0) || !(long_term_var >= 0) || !(corr >= -1 && corr <= 1)) {
+		cout << "The Heston variances must be non-negative, and the correlation between -1 and 1." << endl;
+		exit(-1);
+	}
+	setRate(rate);
+	setSpot(spot);
+	setInitialVar(initial_var);
+	setMeanReversion(mean_reversion);
+	setLongTermVar(long_term_var);
+	setVolOfVar(vol_of_var);
+	setCorr(corr);
+}
+
+void HestonModel::setMeanReversion(double mean_reversion) {
+
+	/* The QE variance law divides by the mean reversion speed : it must be positive. */
+
+	if (!(mean_reversion > 0)) {
+		cout << "The Heston mean reversion speed must be positive." << endl;
+		exit(-1);
+	}
+	kappa = mean_reversion;
+}
+
+void HestonModel::setVolOfVar(double vol_of_var) {
+
+	/* The QE spot scheme and the characteristic function divide by the volatility of the variance : it must be positive. */
+
+	if (!(vol_of_var > 0)) {
+		cout << "The Heston volatility of the variance must be positive." << endl;
+		exit(-1);
+	}
+	xi = vol_of_var;
+}
+
+void HestonModel::varianceLaw(double prev_v, double dt, double& psi, double& first, double& second) {
+	/*
+		Andersen's Quadratic-Exponential law of v(t + dt) given v(t) : its first two moments m and s^2 are matched either by a squared Gaussian
+		a (b + Z)^2 (psi = s^2 / m^2 <= 1.5), or by a mixture of a Dirac in 0 with probability p and an exponential of rate beta (psi > 1.5).
+		A zero mean (zero initial and long term variances) is the Dirac in 0 : a = b^2 = 0.
+	*/
+	double e = exp(-kappa * dt);
+	double m = theta + (prev_v - theta) * e;
+	double s2 = prev_v * xi * xi * e * (1 - e) / kappa + theta * xi * xi * (1 - e) * (1 - e) / (2 * kappa);
+	if (!(m > 0)) {
+		psi = first = second = 0;
+		return;
+	}
+	psi = s2 / (m * m);
+
+	if (psi <= 1.5) {
+		double b2 = 2 / psi - 1 + sqrt(2 / psi) * sqrt(2 / psi - 1);
+		first = m / (1 + b2);
+		second = b2;
+		return;
+	}
+	first = (psi - 1) / (psi + 1);
+	second = (1 - first) / m;
+}
+
+double HestonModel::varianceSimulation(double prev_v, double dt, double rnd_normal) {
+	/*
+		Variance simulation between t and t + dt : Andersen's Quadratic-Exponential scheme.
+		The squared Gaussian uses "rnd_normal" directly, the uniform of the exponential mixture is N(rnd_normal).
+	*/
+	double psi, first, second;
+	varianceLaw(prev_v, dt, psi, first, second);
+
+	if (psi <= 1.5)
+		return first * pow(sqrt(second) + rnd_normal, 2);
+
+	double u = std_normal_cum(rnd_normal);
+	return u <= first ? 0 : log((1 - first) / (1 - u)) / second;
+}
+
+double HestonModel::simulation(double prev_S, double prev_v, double next_v, double dt, double rnd_normal) {
+	/*
+		Spot price simulation between t and t + dt : Andersen's log-spot discretization, with the central rule for the integrated variance.
+		The correlation with the variance is carried by v(t + dt) - v(t), so "rnd_normal" is independent from the variance normal.
+		Martingale correction (Andersen, 2008) : k0 is replaced by -ln E[exp(A v(t + dt))] - (k1 + k3 / 2) v(t), with A = k2 + k3 / 2 and the
+		expectation under the QE law, so that the discounted spot is an exact martingale of the scheme. The expectation is infinite when A reaches
+		1 / (2 a) or beta, which only happens for extreme parameters : k0 is then left uncorrected.
+	*/
+	double k0 = -rho * kappa * theta * dt / xi;
+	double k1 = 0.5 * dt * (kappa * rho / xi - 0.5) - rho / xi;
+	double k2 = 0.5 * dt * (kappa * rho / xi - 0.5) + rho / xi;
+	double k3 = 0.5 * dt * (1 - rho * rho);
+
+	double A = k2 + k3 / 2;
+	double psi, first, second, M = 0;
+	varianceLaw(prev_v, dt, psi, first, second);
+	if (psi <= 1.5 && 2 * A * first < 1)
+		M = exp(A * second * first / (1 - 2 * A * first)) / sqrt(1 - 2 * A * first);
+	else if (psi > 1.5 && A < second)
+		M = first + second * (1 - first) / (second - A);
+	if (M > 0)
+		k0 = -log(M) - (k1 + k3 / 2) * prev_v;
+
+	return prev_S * exp(r * dt + k0 + k1 * prev_v + k2 * next_v + sqrt(k3 * (prev_v + next_v)) * rnd_normal);
+}
+
+complex<double> HestonModel::characteristicFunction(complex<double> u, double T) {
+	/*
+		Characteristic function of ln(S_T / F_T).
+		Albrecher et al. formulation ("The little Heston trap"), continuous in u for long maturities.
+	*/
+	complex<double> i(0, 1);
+	complex<double> beta = kappa - rho * xi * i * u;
+	complex<double> d = sqrt(beta * beta + xi * xi * (i * u + u * u));
+	complex<double> g = (beta - d) / (beta + d);
+	complex<double> e = exp(-d * T);
+	complex<double> C = kappa * theta / (xi * xi) * ((beta - d) * T - 2. * log((1. - g * e) / (1. - g)));
+	complex<double> D = (beta - d) / (xi * xi) * (1. - e) / (1. - g * e);
+	return exp(C + D * v0);
+}
+
+double HestonModel::price(Option* opt) {
+
+	/* Heston Vanilla price of the Option. */
+
+	return price(opt->getStrike(), opt->getMaturity(), opt->getPhi());
+}
+
+double HestonModel::price(double K, double T, int phi) {
+	/*
+		Heston Vanilla price : Lewis' formula, a single integral of the characteristic function along Im(u) = -1/2.
+		Call = S - sqrt(S K df) / pi * Integral_0^inf Re[exp(i u k) phi(u - i/2)] / (u^2 + 1/4) du, with k = ln(F / K).
+		The Put follows from the Call-Put parity. The integral is computed with Simpson's rule, up to the point where the integrand is negligible.
+		A non-positive strike (k infinite) and a zero variance (deterministic spot) have no integral : their price is the discounted intrinsic value.
+	*/
+	double df = exp(-r * T);
+	if (K <= 0 || (v0 == 0 && theta == 0))
+		return max(phi * (S - K * df), 0.);
+	double k = log(S / (K * df));
+
+	// Truncation where the integrand modulus falls below 1e-12, and step small enough for the oscillations of exp(i u k)
+	double u_max = 10;
+	while (abs(characteristicFunction(complex<double>(u_max, -0.5), T)) / (u_max * u_max + 0.25) > 1e-12 && u_max < 5000)
+		u_max *= 1.5;
+	double h = min(0.025, 0.1 / max(fabs(k), 1.));
+	int n = 2 * (int)ceil(u_max / (2 * h));
+	h = u_max / n;
+	double integral = 0;
+
+	for (int j = 0; j <= n; j++) {
+		double u = j * h;
+		double weight = (j == 0 || j == n) ? 1 : (j % 2 == 1 ? 4 : 2);
+		complex<double> cf = characteristicFunction(complex<double>(u, -0.5), T);
+		integral += weight * real(exp(complex<double>(0, u * k)) * cf) / (u * u + 0.25);
+	}
+	integral *= h / 3;
+
+	double call = S - sqrt(S * K * df) * integral / 3.14159265358979323846;
+	return phi == 1 ? call : call - S + K * df;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Option.h"
+#include <complex>
+
+/*
+	The Header file of the class "HestonModel".
+	The "HestonModel" is the stochastic volatility model : dS = r S dt + sqrt(v) S dW_S, dv = kappa (theta - v) dt + xi sqrt(v) dW_v, with d<W_S, W_v> = rho dt.
+	The paths are simulated with Andersen's Quadratic-Exponential scheme, and the Vanillas are priced with the characteristic function.
+*/
+
+class HestonModel {
+protected :
+	double r; // ZC Rate.
+	double S; // The Underlying Spot Price.
+	double v0; // The initial Variance.
+	double kappa; // The Variance mean reversion speed.
+	double theta; // The Variance long term mean.
+	double xi; // The Volatility of the Variance.
+	double rho; // The correlation between the Spot and the Variance Brownian motions.
+	void varianceLaw(double prev_v, double dt, double& psi, double& first, double& second); // QE law of v(t + dt) given v(t) : (a, b^2) of the squared Gaussian for psi <= 1.5, (p, beta) of the exponential mixture otherwise.
+public :
+	HestonModel(double rate, double spot, double initial_var, double mean_reversion, double long_term_var, double vol_of_var, double corr);
+	void setRate(double rate) { r = rate; };
+	double getRate() { return r; };
+	void setSpot(double spot) { S = spot; };
+	double getSpot() { return S; };
+	void setInitialVar(double var) { v0 = var; };
+	double getInitialVar() { return v0; };
+	void setMeanReversion(double mean_reversion); // Exits when the speed is not positive.
+	double getMeanReversion() { return kappa; };
+	void setLongTermVar(double var) { theta = var; };
+	double getLongTermVar() { return theta; };
+	void setVolOfVar(double vol_of_var); // Exits when the volatility is not positive.
+	double getVolOfVar() { return xi; };
+	void setCorr(double corr) { rho = corr; };
+	double getCorr() { return rho; };
+	double varianceSimulation(double prev_v, double dt, double rnd_normal); // The QE variance simulation between t and t + dt. It is called in the "MonteCarlo" class.
+	double simulation(double prev_S, double prev_v, double next_v, double dt, double rnd_normal); // The QE spot simulation between t and t + dt, given the simulated variances. It is called in the "MonteCarlo" class.
+	complex<double> characteristicFunction(complex<double> u, double T); // Characteristic function of ln(S_T / F_T), with F_T the forward price.
+	double price(Option* opt); // The semi-analytic Vanilla price.
+	double price(double K, double T, int phi); // The semi-analytic Vanilla price of the contract terms, without an Option.
+};
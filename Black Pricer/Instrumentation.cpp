@@ -0,0 +1,225 @@
+#include "Instrumentation.h"
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+/*
+	The Source file of the "Instrumentation" of the Monte-Carlo engine.
+	Every thread owns its counters, so the hot path never takes a lock : the owner thread is the only writer, and the relaxed atomics
+	only make the concurrent reads of "getStats" well defined. The counters are never freed, so the stats of finished threads remain.
+*/
+
+const char* PHASE_NAMES[PHASE_COUNT] = { "rng", "simulation", "payoff" };
+const size_t MAX_TRACE_EVENTS = 1 << 16; // Per thread : the later pricing calls are counted but not traced.
+
+struct TraceEvent {
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+	uint64_t allocations;
+};
+
+struct ThreadCounters {
+	int thread = 0;
+	atomic<uint64_t> cycles[PHASE_COUNT] = {};
+	atomic<uint64_t> calls[PHASE_COUNT] = {};
+	atomic<uint64_t> prices{ 0 };
+	atomic<uint64_t> paths{ 0 };
+	atomic<uint64_t> steps{ 0 };
+	atomic<uint64_t> allocations{ 0 };
+	mutex events_mutex; // Only contended while a trace is written.
+	vector<TraceEvent> events;
+};
+
+static thread_local uint64_t thread_allocations = 0; // Plain thread-local counter : the allocation sites are in the hot path.
+
+static mutex& registry_mutex() {
+	static mutex* m = new mutex();
+	return *m;
+}
+
+static vector<ThreadCounters*>& registry() {
+	static vector<ThreadCounters*>* threads = new vector<ThreadCounters*>();
+	return *threads;
+}
+
+static ThreadCounters& counters() {
+
+	/* Counters of the calling thread, registered on the first call. */
+
+	static thread_local ThreadCounters* local = nullptr;
+	if (!local) {
+		ThreadCounters* c = new ThreadCounters();
+		lock_guard<mutex> lock(registry_mutex());
+		c->thread = (int)registry().size();
+		registry().push_back(c);
+		local = c;
+	}
+	return *local;
+}
+
+static void increment(atomic<uint64_t>& counter, uint64_t value) {
+
+	/* Single writer : a relaxed load and store is enough, and cheaper than a read-modify-write. */
+
+	counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+struct Clock {
+
+	/* Origin of the ticks, to convert them in nanoseconds and to timestamp the trace. */
+
+	uint64_t ticks0;
+	chrono::steady_clock::time_point time0;
+	Clock() : ticks0(Instrumentation::ticks()), time0(chrono::steady_clock::now()) {};
+	double nsPerTick() const {
+		uint64_t ticks = Instrumentation::ticks() - ticks0;
+		double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - time0).count();
+		return ticks > 0 ? ns / ticks : 1;
+	};
+};
+
+static Clock& clock_origin() {
+	static Clock origin;
+	return origin;
+}
+
+static bool clock_started = (clock_origin(), true);
+
+void Instrumentation::addPhase(PricerPhase phase, uint64_t cycles) {
+	ThreadCounters& c = counters();
+	increment(c.cycles[phase], cycles * PHASE_SAMPLING);
+	increment(c.calls[phase], PHASE_SAMPLING);
+}
+
+void Instrumentation::addPaths(uint64_t paths, uint64_t steps) {
+	ThreadCounters& c = counters();
+	increment(c.paths, paths);
+	increment(c.steps, steps);
+}
+
+void Instrumentation::addSpan(const char* name, uint64_t start, uint64_t end, uint64_t allocations) {
+	ThreadCounters& c = counters();
+	increment(c.prices, 1);
+	increment(c.allocations, allocations);
+	lock_guard<mutex> lock(c.events_mutex);
+	if (c.events.size() < MAX_TRACE_EVENTS)
+		c.events.push_back({ name, start, end, allocations });
+}
+
+void Instrumentation::addAllocations(uint64_t allocations) {
+	thread_allocations += allocations;
+}
+
+uint64_t Instrumentation::getAllocations() {
+	return thread_allocations;
+}
+
+PricerStats Instrumentation::getStats() {
+	PricerStats stats;
+#ifdef BLACKPRICER_INSTRUMENTATION
+	stats.enabled = true;
+#endif
+	double ns_per_tick = clock_origin().nsPerTick();
+
+	lock_guard<mutex> lock(registry_mutex());
+	for (ThreadCounters* c : registry()) {
+		ThreadStats t;
+		t.thread = c->thread;
+		for (int p = 0; p < PHASE_COUNT; p++) {
+			t.phases[p].cycles = c->cycles[p].load(memory_order_relaxed);
+			t.phases[p].ns = t.phases[p].cycles * ns_per_tick;
+			t.phases[p].calls = c->calls[p].load(memory_order_relaxed);
+			stats.total.phases[p].cycles += t.phases[p].cycles;
+			stats.total.phases[p].ns += t.phases[p].ns;
+			stats.total.phases[p].calls += t.phases[p].calls;
+		}
+		t.prices = c->prices.load(memory_order_relaxed);
+		t.paths = c->paths.load(memory_order_relaxed);
+		t.steps = c->steps.load(memory_order_relaxed);
+		t.allocations = c->allocations.load(memory_order_relaxed);
+		stats.total.prices += t.prices;
+		stats.total.paths += t.paths;
+		stats.total.steps += t.steps;
+		stats.total.allocations += t.allocations;
+		stats.threads.push_back(t);
+	}
+	stats.total.thread = -1;
+	return stats;
+}
+
+void Instrumentation::reset() {
+	lock_guard<mutex> lock(registry_mutex());
+	for (ThreadCounters* c : registry()) {
+		for (int p = 0; p < PHASE_COUNT; p++) {
+			c->cycles[p].store(0, memory_order_relaxed);
+			c->calls[p].store(0, memory_order_relaxed);
+		}
+		c->prices.store(0, memory_order_relaxed);
+		c->paths.store(0, memory_order_relaxed);
+		c->steps.store(0, memory_order_relaxed);
+		c->allocations.store(0, memory_order_relaxed);
+		lock_guard<mutex> events_lock(c->events_mutex);
+		c->events.clear();
+	}
+}
+
+static string thread_stats_json(const ThreadStats& t) {
+	ostringstream out;
+	out << "{\"thread\":" << t.thread << ",\"prices\":" << t.prices << ",\"paths\":" << t.paths << ",\"steps\":" << t.steps
+		<< ",\"allocations\":" << t.allocations << ",\"phases\":{";
+	for (int p = 0; p < PHASE_COUNT; p++)
+		out << (p > 0 ? "," : "") << "\"" << PHASE_NAMES[p] << "\":{\"cycles\":" << t.phases[p].cycles
+			<< ",\"ns\":" << (uint64_t)t.phases[p].ns << ",\"calls\":" << t.phases[p].calls << "}";
+	out << "}}";
+	return out.str();
+}
+
+string PricerStats::toJSON() const {
+	ostringstream out;
+	out << "{\"enabled\":" << (enabled ? "true" : "false") << ",\"total\":" << thread_stats_json(total) << ",\"threads\":[";
+	for (size_t i = 0; i < threads.size(); i++)
+		out << (i > 0 ? "," : "") << thread_stats_json(threads[i]);
+	out << "]}";
+	return out.str();
+}
+
+void Instrumentation::writeJSON(ostream& out) {
+	out << getStats().toJSON() << '\n';
+}
+
+void Instrumentation::writeTrace(ostream& out) {
+	/*
+		Chrome trace event format : one complete event ("X") per pricing call, with its heap allocations,
+		and one counter event ("C") per thread with the time spent in each phase.
+	*/
+	double ns_per_tick = clock_origin().nsPerTick();
+	uint64_t ticks0 = clock_origin().ticks0;
+	bool first = true;
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	lock_guard<mutex> lock(registry_mutex());
+	for (ThreadCounters* c : registry()) {
+		out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << c->thread
+			<< ",\"args\":{\"name\":\"pricer thread " << c->thread << "\"}}";
+		first = false;
+
+		uint64_t last = ticks0;
+		lock_guard<mutex> events_lock(c->events_mutex);
+		for (const TraceEvent& e : c->events) {
+			out << ",{\"name\":\"" << e.name << "\",\"cat\":\"pricer\",\"ph\":\"X\",\"pid\":1,\"tid\":" << c->thread
+				<< ",\"ts\":" << (e.start - ticks0) * ns_per_tick / 1000 << ",\"dur\":" << (e.end - e.start) * ns_per_tick / 1000
+				<< ",\"args\":{\"allocations\":" << e.allocations << "}}";
+			last = max(last, e.end);
+		}
+
+		out << ",{\"name\":\"phases_ns\",\"ph\":\"C\",\"pid\":1,\"tid\":" << c->thread << ",\"ts\":" << (last - ticks0) * ns_per_tick / 1000 << ",\"args\":{";
+		for (int p = 0; p < PHASE_COUNT; p++)
+			out << (p > 0 ? "," : "") << "\"" << PHASE_NAMES[p] << "\":" << (uint64_t)(c->cycles[p].load(memory_order_relaxed) * ns_per_tick);
+		out << "}}";
+	}
+	out << "]}\n";
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PRICER_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PRICER_HAS_RDTSC
+#endif
+
+using namespace std;
+
+/*
+	The Header file of the "Instrumentation" of the Monte-Carlo engine.
+	Per-thread counters of the hot path : cycles spent in each phase (random numbers, path simulation, payoff), paths, time steps,
+	heap allocations of the engine, and a trace of the pricing calls. The counters are read with "Instrumentation::getStats", and dumped as JSON
+	or as Chrome trace events (chrome://tracing, Perfetto).
+	The PRICER_* macros compile to nothing unless BLACKPRICER_INSTRUMENTATION is defined.
+	The allocations are counted where the Monte-Carlo engine allocates its paths, its normals, its reused buffers and its Schedules, models included
+	(PRICER_COUNT_ALLOCATIONS) : the process allocator is left untouched, and the allocations of the callers, of the closed-form pricers and of
+	the instrumentation itself are not counted. tests/allocation_count.cpp checks the counts of every engine against a replaced operator new.
+	The phases are timed on one section out of PHASE_SAMPLING only, and their cycles are scaled up : reading the time stamp counter
+	on every path would cost as much as a one-step path. Define BLACKPRICER_PHASE_SAMPLING to 1 to time every section.
+*/
+
+#ifndef BLACKPRICER_PHASE_SAMPLING
+#define BLACKPRICER_PHASE_SAMPLING 16
+#endif
+
+const uint32_t PHASE_SAMPLING = BLACKPRICER_PHASE_SAMPLING;
+
+enum PricerPhase { PHASE_RNG, PHASE_SIMULATION, PHASE_PAYOFF, PHASE_COUNT };
+
+struct PhaseStats {
+	uint64_t cycles = 0; // Time stamp counter ticks (nanoseconds on platforms without a time stamp counter), estimated from the sampled sections.
+	double ns = 0; // Cycles converted in nanoseconds.
+	uint64_t calls = 0; // Number of sections, sampled or not.
+};
+
+struct ThreadStats {
+	int thread = 0; // Registration index of the thread.
+	PhaseStats phases[PHASE_COUNT];
+	uint64_t prices = 0; // Number of pricing calls.
+	uint64_t paths = 0; // Number of simulated paths.
+	uint64_t steps = 0; // Number of simulated time steps, summed over the paths.
+	uint64_t allocations = 0; // Number of heap allocations of the Monte-Carlo engine during the pricing calls.
+};
+
+struct PricerStats {
+	bool enabled = false; // False when the instrumentation is compiled out.
+	ThreadStats total; // Sum over the threads.
+	vector<ThreadStats> threads;
+	string toJSON() const;
+};
+
+class Instrumentation {
+public :
+	static uint64_t ticks() {
+#ifdef PRICER_HAS_RDTSC
+		return __rdtsc();
+#else
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	};
+	static bool samplePhase(PricerPhase phase) {
+		static thread_local uint32_t sections[PHASE_COUNT] = {};
+		return sections[phase]++ % PHASE_SAMPLING == 0;
+	}; // True for one section of the phase out of PHASE_SAMPLING.
+	static void addPhase(PricerPhase phase, uint64_t cycles); // Adds a sampled section : cycles and calls are scaled by PHASE_SAMPLING.
+	static void addPaths(uint64_t paths, uint64_t steps);
+	static void addSpan(const char* name, uint64_t start, uint64_t end, uint64_t allocations);
+	static void addAllocations(uint64_t allocations); // Counts heap allocations of the engine on the calling thread.
+	static uint64_t getAllocations(); // Heap allocations of the engine on the calling thread since its start.
+	static PricerStats getStats(); // Snapshot of the counters of every thread.
+	static void reset(); // Sets every counter to 0 and clears the trace.
+	static void writeJSON(ostream& out); // Writes "getStats().toJSON()".
+	static void writeTrace(ostream& out); // Writes the pricing calls and the counters in the Chrome trace event format.
+};
+
+class PhaseTimer {
+	/* Adds the ticks elapsed between its construction and its destruction to the phase, when the section is sampled. */
+private :
+	PricerPhase phase;
+	bool sampled;
+	uint64_t start;
+public :
+	PhaseTimer(PricerPhase p) : phase(p), sampled(Instrumentation::samplePhase(p)), start(sampled ? Instrumentation::ticks() : 0) {};
+	~PhaseTimer() { if (sampled) Instrumentation::addPhase(phase, Instrumentation::ticks() - start); };
+};
+
+class SpanTimer {
+	/* Records a trace event for the pricing call, with the heap allocations made during the call. */
+private :
+	const char* name;
+	uint64_t start;
+	uint64_t allocations;
+public :
+	SpanTimer(const char* n) : name(n), start(Instrumentation::ticks()), allocations(Instrumentation::getAllocations()) {};
+	~SpanTimer() { Instrumentation::addSpan(name, start, Instrumentation::ticks(), Instrumentation::getAllocations() - allocations); };
+};
+
+#ifdef BLACKPRICER_INSTRUMENTATION
+#define PRICER_PHASE(phase) PhaseTimer pricer_phase_timer(phase)
+#define PRICER_SPAN(name) SpanTimer pricer_span_timer(name)
+#define PRICER_COUNT_PATHS(paths, steps) Instrumentation::addPaths(paths, steps)
+#define PRICER_COUNT_ALLOCATIONS(allocations) Instrumentation::addAllocations(allocations)
+#else
+#define PRICER_PHASE(phase) ((void)0)
+#define PRICER_SPAN(name) ((void)0)
+#define PRICER_COUNT_PATHS(paths, steps) ((void)0)
+#define PRICER_COUNT_ALLOCATIONS(allocations) ((void)0)
+#endif
@@ -0,0 +1,164 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace std;
+
+/*
+	The Source file of the class "MappedFile".
+	Empty files are open without any mapping : mapping 0 bytes fails on both systems.
+*/
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string& path) {
+
+	/* Read-only mapping of an existing file. */
+
+	HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		error = "cannot open " + path;
+		return;
+	}
+	file = h;
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(h, &file_size);
+	size = (size_t)file_size.QuadPart;
+	if (size > 0) {
+		mapping = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		data = mapping ? (char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data) {
+			error = "cannot map " + path;
+			close();
+			return;
+		}
+	}
+	open = true;
+}
+
+MappedFile::MappedFile(const string& path, size_t file_size) {
+
+	/* Read-write mapping of a new file of "file_size" bytes. */
+
+	HANDLE h = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		error = "cannot create " + path;
+		return;
+	}
+	file = h;
+	size = file_size;
+	writable = true;
+	if (size > 0) {
+		mapping = CreateFileMappingA(h, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+		data = mapping ? (char*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+		if (!data) {
+			error = "cannot map " + path;
+			close();
+			return;
+		}
+	}
+	open = true;
+}
+
+bool MappedFile::flush() {
+	if (!open || !writable || size == 0)
+		return open;
+	return FlushViewOfFile(data, 0) && FlushFileBuffers((HANDLE)file);
+}
+
+void MappedFile::close() {
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping)
+		CloseHandle((HANDLE)mapping);
+	if (file)
+		CloseHandle((HANDLE)file);
+	data = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+	open = false;
+}
+
+#else
+
+MappedFile::MappedFile(const string& path) {
+
+	/* Read-only mapping of an existing file. The pages are read ahead, as the pricing scans the columns sequentially. */
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	struct stat file_stat;
+	if (fd < 0 || fstat(fd, &file_stat) != 0) {
+		error = "cannot open " + path + " : " + strerror(errno);
+		close();
+		return;
+	}
+	size = (size_t)file_stat.st_size;
+	if (size > 0) {
+		void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) {
+			error = "cannot map " + path + " : " + strerror(errno);
+			close();
+			return;
+		}
+		data = (char*)p;
+		madvise(data, size, MADV_SEQUENTIAL);
+	}
+	open = true;
+}
+
+MappedFile::MappedFile(const string& path, size_t file_size) {
+
+	/* Read-write mapping of a new file of "file_size" bytes. */
+
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate(fd, (off_t)file_size) != 0) {
+		error = "cannot create " + path + " : " + strerror(errno);
+		close();
+		return;
+	}
+	size = file_size;
+	writable = true;
+	if (size > 0) {
+		void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) {
+			error = "cannot map " + path + " : " + strerror(errno);
+			close();
+			return;
+		}
+		data = (char*)p;
+	}
+	open = true;
+}
+
+bool MappedFile::flush() {
+	if (!open || !writable || size == 0)
+		return open;
+	return msync(data, size, MS_SYNC) == 0;
+}
+
+void MappedFile::close() {
+	if (data)
+		munmap(data, size);
+	if (fd >= 0)
+		::close(fd);
+	data = nullptr;
+	fd = -1;
+	open = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
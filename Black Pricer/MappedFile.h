@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+/*
+	The Header file of the class "MappedFile".
+	The "MappedFile" maps a whole file in memory (mmap on POSIX systems, file mappings on Windows), and unmaps it on destruction.
+	The file is either opened read-only, or created read-write with a given size : its pages are then written back by the system.
+*/
+
+class MappedFile {
+private :
+	char* data = nullptr;
+	size_t size = 0;
+	bool open = false;
+	bool writable = false;
+	string error; // Reason of the failure when the file is not open.
+#ifdef _WIN32
+	void* file = nullptr; // Windows file handle.
+	void* mapping = nullptr; // Windows file mapping handle.
+#else
+	int fd = -1;
+#endif
+	void close();
+public :
+	MappedFile(const string& path); // Maps an existing file, read-only.
+	MappedFile(const string& path, size_t file_size); // Creates (or truncates) the file with the given size, and maps it read-write.
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+	bool isOpen() { return open; };
+	string getError() { return error; };
+	const char* getData() const { return data; };
+	char* getWritableData() { return writable ? data : nullptr; };
+	size_t getSize() const { return size; };
+	bool flush(); // Writes the modified pages back to the file, and waits for the writes.
+};
@@ -1,7 +1,10 @@
 #include <vector>
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <algorithm>
 #include "MonteCarlo.h"
+#include "Instrumentation.h"
 
 using namespace std;
 
@@ -9,18 +12,83 @@ using namespace std;
 	The Source file of the class "MonteCarlo".
 */
 
-double norm_variable(double mean = 0, double stddev = 1) {
+const int MC_BLOCK = 512; // Paths simulated together by the single precision engine.
+const int MC_BLOCK_FLOATS = 1 << 21; // Floats held by the buffers of a single precision block, at most : 8 MB, below the 16 MB of the normals and the path of a double path of 1 000 000 steps.
+
+template <typename T> static void resize_buffer(vector<T>& buffer, size_t n) {
+
+	/* Resizes a buffer reused by the pricing calls of the thread, and counts its allocation when it grows. */
+
+	if (n > buffer.capacity())
+		PRICER_COUNT_ALLOCATIONS(1);
+	buffer.resize(n);
+}
+
+static std::mt19937& random_engine() {
+
+	/* Random number generator of the thread, seeded once : re-seeding on every draw costs more than the draw itself. */
+
+	static thread_local std::random_device rd;
+	static thread_local std::mt19937 gen(rd());
+	return gen;
+}
+
+double norm_variable(double mean, double stddev) {
 	
 	/* Normal distribution generator based on the Mersenne Twister algorithm. */
 
-	// Seed for the random number generator
-	std::random_device rd;
-	std::mt19937 gen(rd());
-
 	// Create a normal distribution object
 	std::normal_distribution<double> normal_dist(mean, stddev);
 
-	return normal_dist(gen);
+	return normal_dist(random_engine());
+}
+
+void norm_variables(float* normals, int n) {
+	/*
+		Block of n single precision standard normals. The distribution is kept over the whole block, so every pair of uniforms gives two normals,
+		and a float uniform needs a single draw of the Mersenne Twister (a double needs two).
+	*/
+	std::normal_distribution<float> normal_dist;
+	std::mt19937& gen = random_engine();
+	for (int i = 0; i < n; i++)
+		normals[i] = normal_dist(gen);
+}
+
+static double bridge_survival(double S_a, double S_b, double B, bool up, double variance) {
+	/*
+		Probability that a Brownian bridge of the log-spot between S_a and S_b, with total variance sigma^2 dt, does not cross the barrier B.
+		The drift does not change the bridge, so under the log-normal step the probability is exact : 1 - exp(-2 log(B / S_a) log(B / S_b) / (sigma^2 dt)).
+	*/
+	double a = log(B / S_a);
+	double b = log(B / S_b);
+	if (up ? (a <= 0 || b <= 0) : (a >= 0 || b >= 0))
+		return 0;
+	return 1 - exp(-2 * a * b / variance);
+}
+
+static BarrierOption* monitored_barrier(Option* opt) {
+
+	/* The Option as a monitored Barrier, or null : the Asians and the monitored Barriers are the only path-dependent Options. */
+
+	return opt->isPathDependent() && !opt->isAsian() ? static_cast<BarrierOption*>(opt) : nullptr;
+}
+
+static double survival_payoff(BarrierOption* barrier, double S_T, double survival) {
+
+	/* Monitored Barrier payoff : the Vanilla payoff times the probability that the barrier was not crossed, or one minus it for the knock-in Barriers. */
+
+	double vanilla = max(barrier->getPhi() * (S_T - barrier->getStrike()), 0.);
+	return vanilla * (barrier->isKnockIn() ? 1 - survival : survival);
+}
+
+template <typename Real> static double bridge_payoff(BarrierOption* barrier, const Real* path, const Schedule& schedule, double sigma2) {
+
+	/* Monitored Barrier payoff of a BS path [S_0, S_1, ..., S_T] : the survival is the product of the Brownian bridge survivals of the steps. */
+
+	double survival = 1;
+	for (int i = 0; i < schedule.size() && survival > 0; i++)
+		survival *= bridge_survival(path[i], path[i + 1], barrier->getBarrier(), barrier->isUp(), sigma2 * schedule.getDt(i));
+	return survival_payoff(barrier, path[schedule.size()], survival);
 }
 
 MonteCarlo::MonteCarlo(double nb_simulations, double time_steps) { 
@@ -32,117 +100,499 @@ MonteCarlo::MonteCarlo(double nb_simulations, double time_steps) {
 
 }
 
-void MonteCarlo::setTimeSteps(Option* opt) {
+shared_ptr<const Schedule> MonteCarlo::getSchedule(Option* opt) {
 	/*
-		"setTimeSteps" method calls the Option contract, and returns an equivalent time grid used for path simulations.
-		Time steps grid is only needed for path-dependent Options, in our case : Arithmetic Asian Options.
-		For these latter, the method includes the fixing dates needed to compute the average spot price. 
+		"getSchedule" method calls the Option contract, and returns the equivalent time grid used for path simulations.
+		Path-dependent Options, in our case Arithmetic Asian Options and monitored Barrier Options, use "nbSteps" steps and the fixing dates.
+		The other Options use a single step up to the maturity.
+		The grid is built once per (maturity, nbSteps, freq) and shared by every trade and every thread.
 	*/
-	vector<double> grid = vector<double>(1, 0);
-
-	if (opt->getType() == "Asian") {
-		double T = opt->getMaturity();
-		double freq = opt->getFreq();
-		for (int s = 1; s <= nbSteps; s++)
-			grid.push_back(s * (T / nbSteps)); // Dates based on the number of steps 
-		for (int f = 1; f < freq; f++)
-			grid.push_back(f * (T / freq)); // Dates based on the Asian fixing frequency 
-
-		sort(grid.begin(), grid.end()); // Sort the time grid
-
-		// Compute the time steps :
-		vector<double>::iterator it_prev = grid.begin();
-		vector<double>::iterator it = grid.begin();
-		it++;
-		while (it != grid.end()) {
-			timeSteps.push_back(*it - *it_prev);
-			it++;
-			it_prev++;
+	if (opt->isPathDependent())
+		return Schedule::get(opt->getMaturity(), nbSteps, opt->getFreq());
+	return Schedule::get(opt->getMaturity(), 1, 1);
+}
+
+vector<double> MonteCarlo::getBSPath(BlackScholesModel* bs_model, Option* opt, const Schedule& schedule) {
+	/*
+		"getBSPath" method calls the BS model and the Option contract, and returns a simulated path of the spot price on the time grid "schedule".
+		The simulation on every time step is handled by the BS model.
+		Asian Options returned path : Fixings needed to compute the average [F_1, F_2, ..., F_n].
+		Other Options returned path : Every simulated date [S_0, S_1, ..., S_T]. Non path-dependent Options have a single step : [S_0, S_T].
+		The normals of the path are drawn first, so that the random numbers and the simulation are timed separately.
+	*/
+	bool asian = opt->isAsian();
+	int n = schedule.size();
+	static thread_local vector<double> normals; // Buffer reused by every path of the thread.
+	resize_buffer(normals, n);
+	{
+		PRICER_PHASE(PHASE_RNG);
+		for (int i = 0; i < n; ++i)
+			normals[i] = norm_variable();
+	}
+
+	PRICER_PHASE(PHASE_SIMULATION);
+	vector<double> path;
+	path.reserve(n + 1);
+	PRICER_COUNT_ALLOCATIONS(1);
+	double S_t = bs_model->getSpot();
+
+	if (!asian)
+		path.push_back(S_t);
+
+	for (int i = 0; i < n; ++i) {
+		S_t = bs_model->simulation(S_t, schedule.getDt(i), schedule.getSqrtDt(i), normals[i]);
+		if (!asian || schedule.isFixing(i))
+			path.push_back(S_t);
+	}
+
+	return path;
+}
+
+double MonteCarlo::price(BlackScholesModel* bs_model, Option* opt) {
+	/*
+		Black-Scholes Monte-Carlo price.
+		The monitored Barriers are monitored continuously, as in "priceMLMC" : the crossings between the simulated dates are accounted for
+		by the Brownian bridge survival probability of every step, exact under the log-normal step, so the price does not depend on "nbSteps".
+	*/
+	if (singlePrecision)
+		return priceSingle(bs_model, opt);
+
+	PRICER_SPAN("MonteCarlo::price BlackScholes");
+	shared_ptr<const Schedule> schedule = getSchedule(opt);
+	BarrierOption* barrier = monitored_barrier(opt);
+	double sigma2 = pow(bs_model->getVol(), 2);
+	double T = opt->getMaturity();
+	double df = exp(-bs_model->getRate() * T);
+	double price = 0;
+	for (int i = 0; i < nbSimulations; i++) {
+		vector<double> path = getBSPath(bs_model, opt, *schedule);
+		PRICER_PHASE(PHASE_PAYOFF);
+		price += df * (barrier ? bridge_payoff(barrier, path.data(), *schedule, sigma2) : opt->payoff(path)) / nbSimulations;
+	}
+	PRICER_COUNT_PATHS(nbSimulations, nbSimulations * schedule->size());
+	return price;
+}
+
+static int block_paths(int floats_per_path) {
+
+	/* Paths of a single precision block : MC_BLOCK, or as many as MC_BLOCK_FLOATS floats hold when a path needs more than MC_BLOCK_FLOATS / MC_BLOCK. */
+
+	return max(1, min(MC_BLOCK, MC_BLOCK_FLOATS / max(floats_per_path, 1)));
+}
+
+static void store_date(float* paths, const float* spots, int b, int width, int k) {
+
+	/* Stores the spots of the b paths of a block as the date k of their paths : the path j is paths[j * width, (j + 1) * width). */
+
+	for (int j = 0; j < b; j++)
+		paths[(size_t)j * width + k] = spots[j];
+}
+
+static void add_compensated(double& sum, double& compensation, double value) {
+
+	/* Kahan summation : "compensation" keeps the low-order bits lost by "sum". */
+
+	double y = value - compensation;
+	double t = sum + y;
+	compensation = (t - sum) - y;
+	sum = t;
+}
+
+double MonteCarlo::priceSingle(BlackScholesModel* bs_model, Option* opt) {
+	/*
+		Black-Scholes Monte-Carlo price on single precision paths.
+		The paths are simulated one block at a time, one time step over the whole block after the other, in float : twice the paths per vector
+		register, and loops over the paths that the compiler vectorizes. The stored paths have the same dates as in "getBSPath" :
+		[S_0, S_1, ..., S_T], or the fixings for the Asian Options. The path j of the block is paths[j * width, (j + 1) * width), and its payoff
+		is evaluated there, in double, without copying it, and with the Brownian bridge for the monitored Barriers as in "price".
+		The block holds up to MC_BLOCK paths, fewer on the long grids (see "block_paths").
+		Each block is summed in double, and the block sums are added with a compensated (Kahan) sum, so the rounding of the accumulation does
+		not grow with the number of paths.
+	*/
+	PRICER_SPAN("MonteCarlo::priceSingle BlackScholes");
+	shared_ptr<const Schedule> schedule = getSchedule(opt);
+	bool asian = opt->isAsian();
+	int n = schedule->size();
+	int width = asian ? 0 : n + 1;
+	for (int i = 0; asian && i < n; i++)
+		width += schedule->isFixing(i);
+	int block = block_paths(n + 1 + width);
+	BarrierOption* barrier = monitored_barrier(opt);
+	double sigma2 = pow(bs_model->getVol(), 2);
+
+	static thread_local vector<float> normals, spots, paths; // Buffers reused by every block of the thread.
+	resize_buffer(normals, (size_t)block * n);
+	resize_buffer(spots, block);
+	resize_buffer(paths, (size_t)block * width);
+
+	long long nb_paths = (long long)nbSimulations;
+	double sum = 0, compensation = 0;
+	for (long long first = 0; first < nb_paths; first += block) {
+		int b = (int)min((long long)block, nb_paths - first);
+		{
+			PRICER_PHASE(PHASE_RNG);
+			norm_variables(normals.data(), b * n);
 		}
+		{
+			PRICER_PHASE(PHASE_SIMULATION);
+			fill(spots.begin(), spots.begin() + b, (float)bs_model->getSpot());
+			int k = 0;
+			if (!asian)
+				store_date(paths.data(), spots.data(), b, width, k++);
+			for (int i = 0; i < n; i++) {
+				bs_model->simulation(spots.data(), normals.data() + (size_t)i * b, b, schedule->getDt(i), schedule->getSqrtDt(i));
+				if (!asian || schedule->isFixing(i))
+					store_date(paths.data(), spots.data(), b, width, k++);
+			}
+		}
+		PRICER_PHASE(PHASE_PAYOFF);
+		double block_sum = 0;
+		for (int j = 0; j < b; j++) {
+			const float* path = paths.data() + (size_t)j * width;
+			block_sum += barrier ? bridge_payoff(barrier, path, *schedule, sigma2) : opt->payoff(path, width);
+		}
+		add_compensated(sum, compensation, block_sum);
 	}
+	PRICER_COUNT_PATHS(nbSimulations, nbSimulations * n);
+	return exp(-bs_model->getRate() * opt->getMaturity()) * sum / nbSimulations;
 }
 
-vector<double> MonteCarlo::getBSPath(BlackScholesModel* bs_model, Option* opt) {
+void MonteCarlo::getMLMCSample(BlackScholesModel* bs_model, Option* opt, int level, const Schedule& schedule, double& fine_payoff, double& coarse_payoff) {
 	/*
-		"getBSPath" method calls the BS model and the Option contract, and returns a simulated path of the spot price.
-		The simulation on every time step is handled by the BS model.
+		"getMLMCSample" method simulates one pair of coupled paths for the MLMC level "level".
+		The fine path splits every step of the base grid "schedule" into 2^level sub-steps, the coarse path into 2^(level - 1) sub-steps.
+		The coarse path is driven by the sum of the fine Brownian increments, so both paths share the same Brownian motion.
+		Monitored Barriers : instead of the indicator of the simulated dates, each path carries the product of the Brownian bridge survival
+		probabilities of its (sub-)steps, and the payoff is the Vanilla payoff times the survival (or one minus it for the knock-in Barriers).
+		Each coarse step is split at the midpoint given by its first fine increment (Giles, 2008), and the coarse survival is the product of
+		the two half-step bridges : the payoff is smooth, and under the exact log-normal step the coarse payoff matches the fine one.
+		Level 0 has no coarse path : "coarse_payoff" is set to 0.
 	*/
+	bool asian = opt->isAsian();
+	BarrierOption* barrier = monitored_barrier(opt);
+	int nb_sub_steps = 1 << level;
+	double fine_S = bs_model->getSpot();
+	double coarse_S = fine_S;
+	double coarse_rnd = 0, first_rnd = 0;
+	double fine_survival = 1, coarse_survival = 1;
+	double sigma2 = pow(bs_model->getVol(), 2);
+	vector<double> fine_path;
+	vector<double> coarse_path;
 
-	// Init : S_0
-	vector<double> path = vector<double>(1, bs_model->getSpot());
-
-	if (opt->getType() == "Asian") {
-		/*
-			Asian Options : Path-dependent simulation on the time steps grid.
-			Returned path : Fixings needed to compute the average [F_1, F_2, ..., F_n].
-		*/
-		double freq = opt->getFreq();
-		vector<double> fixings;
-		double prev_S;
-		double t = 0;
-
-		for (int i = 0; i < timeSteps.size(); ++i) {
-			prev_S = path.back();
-			if (timeSteps[i] != 0) {
-				path.push_back(bs_model->simulation(prev_S, timeSteps[i], norm_variable()));
-				t += timeSteps[i];
-				if (floor(freq * t) == freq * t)
-					fixings.push_back(path.back());
+	if (!barrier) {
+		// The fixings, or every date of the terminal payoffs
+		fine_path.reserve(asian ? schedule.size() : schedule.size() * nb_sub_steps + 1);
+		coarse_path.reserve(level == 0 ? 0 : asian ? schedule.size() : schedule.size() * nb_sub_steps / 2 + 1);
+		PRICER_COUNT_ALLOCATIONS(level == 0 ? 1 : 2);
+	}
+	if (!asian && !barrier) {
+		fine_path.push_back(fine_S);
+		if (level > 0)
+			coarse_path.push_back(coarse_S);
+	}
+
+	for (int i = 0; i < schedule.size(); i++) {
+		double fine_dt = schedule.getDt(i) / nb_sub_steps;
+		double fine_sqrt_dt = schedule.getSqrtDt(i) / pow(nb_sub_steps, 0.5);
+		for (int k = 0; k < nb_sub_steps; k++) {
+			double rnd = norm_variable();
+			double prev_fine_S = fine_S;
+			fine_S = bs_model->simulation(fine_S, fine_dt, fine_sqrt_dt, rnd);
+			if (barrier)
+				fine_survival *= bridge_survival(prev_fine_S, fine_S, barrier->getBarrier(), barrier->isUp(), sigma2 * fine_dt);
+			else if (!asian)
+				fine_path.push_back(fine_S);
+			if (level > 0) {
+				coarse_rnd += rnd;
+				if (k % 2 == 0)
+					first_rnd = rnd;
+				else {
+					double prev_coarse_S = coarse_S;
+					coarse_S = bs_model->simulation(coarse_S, 2 * fine_dt, fine_sqrt_dt, coarse_rnd); // sqrt(2 dt) * (Z_1 + Z_2) / sqrt(2) = sqrt(dt) * (Z_1 + Z_2)
+					coarse_rnd = 0;
+					if (barrier) {
+						double mid_S = bs_model->simulation(prev_coarse_S, fine_dt, fine_sqrt_dt, first_rnd);
+						coarse_survival *= bridge_survival(prev_coarse_S, mid_S, barrier->getBarrier(), barrier->isUp(), sigma2 * fine_dt)
+							* bridge_survival(mid_S, coarse_S, barrier->getBarrier(), barrier->isUp(), sigma2 * fine_dt);
+					}
+					else if (!asian)
+						coarse_path.push_back(coarse_S);
+				}
 			}
 		}
+		if (asian && schedule.isFixing(i)) {
+			fine_path.push_back(fine_S);
+			if (level > 0)
+				coarse_path.push_back(coarse_S);
+		}
+	}
 
-		return fixings;
-	} 
-	else {
-		/* 
-			Non-Path Dependent Options : Directly simulate the spot price at maturity S_T.
-			Returned path : [S_0, S_T]
-		*/
-		double T = opt->getMaturity();
-		path.push_back(bs_model->simulation(path[0], T, norm_variable()));
-		return path;
-	} 
+	if (barrier) {
+		fine_payoff = survival_payoff(barrier, fine_S, fine_survival);
+		coarse_payoff = level > 0 ? survival_payoff(barrier, coarse_S, coarse_survival) : 0;
+		return;
+	}
+	fine_payoff = opt->payoff(fine_path);
+	coarse_payoff = level > 0 ? opt->payoff(coarse_path) : 0;
 }
 
-double MonteCarlo::price(BlackScholesModel* bs_model, Option* opt) {
-	
-	/* Black-Scholes Monte-Carlo price. */
+double MonteCarlo::priceMLMC(BlackScholesModel* bs_model, Option* opt, double target_rmse, int max_level) {
+	/*
+		Black-Scholes Multilevel Monte-Carlo price (Giles, 2008).
+		The level l estimates E[P_l - P_(l-1)] on the time steps grid refined 2^l times, with P_(-1) = 0.
+		The number of paths per level is N_l ~ sqrt(V_l / C_l) * sum(sqrt(V_k * C_k)) / eps^2, with V_l the estimated variance and C_l = 2^l the cost of the level.
+		Levels are added until the estimated weak error of the finest level falls below the bias share of "target_rmse".
+		Under the exact log-normal step the payoffs of the Asians and of the non path-dependent Options do not depend on the grid :
+		their corrections vanish, so they are priced on level 0 only, with the whole "target_rmse" given to the variance.
+		The monitored Barriers start on level 0 as well, and a finer level is only kept while its corrections are not zero : with the Brownian
+		bridge their estimator is the continuously monitored price on any grid, so the first correction level usually ends the refinement.
+	*/
+	bool grid_independent = !opt->isPathDependent() || opt->isAsian();
+	double theta = grid_independent ? 0 : 0.25; // Share of the squared error allowed for the bias.
+	double initial_paths = 1000;
+
+	PRICER_SPAN("MonteCarlo::priceMLMC BlackScholes");
+
+	// Base grid : the time steps grid of the Option, refined 2^l times on the level l
+	shared_ptr<const Schedule> schedule = getSchedule(opt);
+
+	int L = 0;
+	vector<double> nb_paths(max_level + 1, 0);
+	vector<double> new_paths(max_level + 1, initial_paths);
+	vector<double> sum_P(max_level + 1, 0);
+	vector<double> sum_P2(max_level + 1, 0);
+	vector<double> means(max_level + 1, 0);
+	vector<double> variances(max_level + 1, 0);
+	PRICER_COUNT_ALLOCATIONS(6);
+
+	while (true) {
+		// Simulate the missing paths on every level
+		for (int l = 0; l <= L; l++) {
+			for (int n = 0; n < new_paths[l]; n++) {
+				double fine_payoff, coarse_payoff;
+				getMLMCSample(bs_model, opt, l, *schedule, fine_payoff, coarse_payoff);
+				sum_P[l] += fine_payoff - coarse_payoff;
+				sum_P2[l] += pow(fine_payoff - coarse_payoff, 2);
+			}
+			nb_paths[l] += new_paths[l];
+			PRICER_COUNT_PATHS(new_paths[l], new_paths[l] * schedule->size() * (1 << l));
+		}
+
+		// Optimal number of paths per level
+		double sum_sqrt_VC = 0;
+		for (int l = 0; l <= L; l++) {
+			means[l] = fabs(sum_P[l] / nb_paths[l]);
+			variances[l] = max(sum_P2[l] / nb_paths[l] - pow(sum_P[l] / nb_paths[l], 2), 0.);
+			sum_sqrt_VC += pow(variances[l] * pow(2, l), 0.5);
+		}
+		bool converged = true;
+		for (int l = 0; l <= L; l++) {
+			double optimal_paths = ceil(pow(variances[l] / pow(2, l), 0.5) * sum_sqrt_VC / ((1 - theta) * pow(target_rmse, 2)));
+			new_paths[l] = max(optimal_paths - nb_paths[l], 0.);
+			if (new_paths[l] > 0.01 * nb_paths[l])
+				converged = false;
+		}
+		if (!converged)
+			continue;
+		if (grid_independent || (L > 0 && variances[L] <= 1e-20 * variances[0]))
+			break;
+
+		// Weak error of the finest level : E[P_L - P_(L-1)] ~ c * 2^(-alpha * L), alpha fitted on levels 1..L and floored at 0.5. It needs two correction levels.
+		double weak_error = HUGE_VAL;
+		if (L >= 2) {
+			double sum_l = 0, sum_log = 0, sum_l2 = 0, sum_l_log = 0;
+			for (int l = 1; l <= L; l++) {
+				double log_mean = log2(max(means[l], 1e-300));
+				sum_l += l;
+				sum_log += log_mean;
+				sum_l2 += l * l;
+				sum_l_log += l * log_mean;
+			}
+			double slope = (L * sum_l_log - sum_l * sum_log) / (L * sum_l2 - sum_l * sum_l);
+			double alpha = max(-slope, 0.5);
+			weak_error = max(means[L], means[L - 1] / pow(2, alpha)) / (pow(2, alpha) - 1);
+		}
+		if (weak_error <= pow(theta, 0.5) * target_rmse || L == max_level)
+			break;
+
+		// Add a finer level
+		L++;
+	}
 
-	MonteCarlo::setTimeSteps(opt); // Set the time steps grid once for all 
 	double T = opt->getMaturity();
 	double df = exp(-bs_model->getRate() * T);
 	double price = 0;
-	for (int i = 0; i < nbSimulations; i++) 
-		price += df * opt->payoff(getBSPath(bs_model, opt)) / nbSimulations;
+	for (int l = 0; l <= L; l++)
+		price += df * sum_P[l] / nb_paths[l];
 	return price;
 }
 
-
 vector<double> MonteCarlo::getBSPath(MultiAssetBSModel* bs_model, Option* opt) {
 	/*
 		"getBSPath" method calls the Multi-Asset BS model and the Option contract, and returns a simulated path of the spot price.
 		The simulation on every time step is handled by the BS model.
 		Basket and Spread Options : Directly simulate the spot price at maturity S_T.
-		Multi-Asset BS needs a vector of independent standard normal variables.
+		Multi-Asset BS needs a vector of independent standard normal variables : one per underlying, plus one per factor of the factor model.
 	*/
-	double n = bs_model->getSize();
+	double n = bs_model->getNbNormals();
 	double T = opt->getMaturity();
-	vector<double> normal_vector;
+	vector<double> normal_vector(n);
+	PRICER_COUNT_ALLOCATIONS(3); // The normals, the copy of the spots, and the simulated spots : "simulation" allocates nothing else.
+	{
+		PRICER_PHASE(PHASE_RNG);
+		for (int i = 0; i < n; i++)
+			normal_vector[i] = norm_variable();
+	}
 
-	for (int i = 0; i < n; i++)
-		normal_vector.push_back(norm_variable());
-	
-	return bs_model->simulation(bs_model->getSpot(), T, normal_vector);
+	PRICER_PHASE(PHASE_SIMULATION);
+	return bs_model->simulation(bs_model->getSpot(), T, move(normal_vector));
 }
 
 double MonteCarlo::price(MultiAssetBSModel* bs_model, Option* opt) {
 	
 	/* Multi-Asset Black-Scholes Monte-Carlo price. */
 
+	if (singlePrecision)
+		return priceSingle(bs_model, opt);
+
+	PRICER_SPAN("MonteCarlo::price MultiAssetBlackScholes");
 	double T = opt->getMaturity();
 	double df = exp(-bs_model->getRate() * T);
 	double price = 0;
-	for (int i = 0; i < nbSimulations; i++)
-		price += df * opt->payoff(getBSPath(bs_model, opt)) / nbSimulations;
+	for (int i = 0; i < nbSimulations; i++) {
+		vector<double> path = getBSPath(bs_model, opt);
+		PRICER_PHASE(PHASE_PAYOFF);
+		price += df * opt->payoff(path) / nbSimulations;
+	}
+	PRICER_COUNT_PATHS(nbSimulations, nbSimulations);
 	return price;
 }
+
+double MonteCarlo::priceSingle(MultiAssetBSModel* bs_model, Option* opt) {
+	/*
+		Multi-Asset Black-Scholes Monte-Carlo price on single precision paths : the spots at maturity are simulated one block at a time in float,
+		then stored path after path, paths[j * d, (j + 1) * d) for the path j, where the payoffs are evaluated and accumulated in double
+		as in the single-asset "priceSingle".
+	*/
+	PRICER_SPAN("MonteCarlo::priceSingle MultiAssetBlackScholes");
+	int d = (int)bs_model->getSize();
+	int nb_normals = bs_model->getNbNormals();
+	vector<double> S_0 = bs_model->getSpot();
+	PRICER_COUNT_ALLOCATIONS(1);
+	int block = block_paths(nb_normals + 2 * d);
+	static thread_local vector<float> normals, spots, paths; // Buffers reused by every block of the thread.
+	resize_buffer(normals, (size_t)block * nb_normals);
+	resize_buffer(spots, (size_t)block * d);
+	resize_buffer(paths, (size_t)block * d);
+
+	long long nb_paths = (long long)nbSimulations;
+	double sum = 0, compensation = 0;
+	for (long long first = 0; first < nb_paths; first += block) {
+		int b = (int)min((long long)block, nb_paths - first);
+		{
+			PRICER_PHASE(PHASE_RNG);
+			norm_variables(normals.data(), b * nb_normals);
+		}
+		{
+			PRICER_PHASE(PHASE_SIMULATION);
+			for (int i = 0; i < d; i++)
+				fill(spots.begin() + i * b, spots.begin() + (i + 1) * b, (float)S_0[i]);
+			bs_model->simulation(spots.data(), normals.data(), b, opt->getMaturity());
+			for (int i = 0; i < d; i++)
+				store_date(paths.data(), spots.data() + i * b, b, d, i);
+		}
+		PRICER_PHASE(PHASE_PAYOFF);
+		double block_sum = 0;
+		for (int j = 0; j < b; j++)
+			block_sum += opt->payoff(paths.data() + (size_t)j * d, d);
+		add_compensated(sum, compensation, block_sum);
+	}
+	PRICER_COUNT_PATHS(nbSimulations, nbSimulations);
+	return exp(-bs_model->getRate() * opt->getMaturity()) * sum / nbSimulations;
+}
+
+vector<double> MonteCarlo::getHestonPath(HestonModel* heston_model, Option* opt, const Schedule& schedule, double* survival) {
+	/*
+		"getHestonPath" method calls the Heston model and the Option contract, and returns a simulated path of the spot price on the time grid "schedule".
+		Asian Options returned path : Fixings needed to compute the average [F_1, F_2, ..., F_n].
+		Other Options returned path : Every simulated date [S_0, S_1, ..., S_T].
+		Monitored Barriers : "survival", when given, receives the product of the Brownian bridge survival probabilities of the steps, with the
+		integrated variance (v(t) + v(t + dt)) dt / 2 of the QE spot step.
+	*/
+	bool asian = opt->isAsian();
+	BarrierOption* barrier = survival ? monitored_barrier(opt) : nullptr;
+	if (survival)
+		*survival = 1;
+	int n = schedule.size();
+	static thread_local vector<double> normals; // Buffer reused by every path of the thread : variance and spot normals of each step.
+	resize_buffer(normals, 2 * n);
+	{
+		PRICER_PHASE(PHASE_RNG);
+		for (int i = 0; i < 2 * n; ++i)
+			normals[i] = norm_variable();
+	}
+
+	PRICER_PHASE(PHASE_SIMULATION);
+	vector<double> path;
+	path.reserve(n + 1);
+	PRICER_COUNT_ALLOCATIONS(1);
+	double S_t = heston_model->getSpot();
+	double v = heston_model->getInitialVar();
+
+	if (!asian)
+		path.push_back(S_t);
+
+	for (int i = 0; i < n; ++i) {
+		double next_v = heston_model->varianceSimulation(v, schedule.getDt(i), normals[2 * i]);
+		double prev_S = S_t;
+		S_t = heston_model->simulation(S_t, v, next_v, schedule.getDt(i), normals[2 * i + 1]);
+		if (barrier)
+			*survival *= bridge_survival(prev_S, S_t, barrier->getBarrier(), barrier->isUp(), (v + next_v) / 2 * schedule.getDt(i));
+		v = next_v;
+		if (!asian || schedule.isFixing(i))
+			path.push_back(S_t);
+	}
+
+	return path;
+}
+
+double MonteCarlo::price(HestonModel* heston_model, Option* opt, bool control_variate) {
+	/*
+		Heston Monte-Carlo price.
+		Control variate : the Vanilla with the same strike, maturity and flavor, evaluated on the same paths, and priced with the characteristic function.
+		The control variate coefficient is the regression coefficient of the payoff on the Vanilla payoff.
+		The QE scheme stays accurate on coarse grids : every Option is simulated on "nbSteps" steps, plus the fixing dates for path-dependent Options.
+		The monitored Barriers are monitored continuously, with the Brownian bridge of "getHestonPath", as in the BS engines.
+	*/
+	PRICER_SPAN("MonteCarlo::price Heston");
+	double freq = opt->isPathDependent() ? opt->getFreq() : 1;
+	shared_ptr<const Schedule> schedule = Schedule::get(opt->getMaturity(), nbSteps, freq);
+	double T = opt->getMaturity();
+	double df = exp(-heston_model->getRate() * T);
+	VanillaOption control(opt->getStrike(), T, opt->getPhi());
+	BarrierOption* barrier = monitored_barrier(opt);
+
+	double sum_Y = 0, sum_X = 0, sum_XY = 0, sum_X2 = 0;
+	for (int i = 0; i < nbSimulations; i++) {
+		double survival;
+		vector<double> path = getHestonPath(heston_model, opt, *schedule, &survival);
+		PRICER_PHASE(PHASE_PAYOFF);
+		double X = control_variate ? control.payoff(path) : 0; // The last date of the path is the maturity, also for the fixings of the Asians.
+		double Y = barrier ? survival_payoff(barrier, path.back(), survival) : opt->payoff(path);
+		sum_Y += Y;
+		sum_X += X;
+		sum_XY += X * Y;
+		sum_X2 += X * X;
+	}
+
+	PRICER_COUNT_PATHS(nbSimulations, nbSimulations * schedule->size());
+
+	double mean_Y = sum_Y / nbSimulations;
+	if (!control_variate)
+		return df * mean_Y;
+
+	double mean_X = sum_X / nbSimulations;
+	double var_X = sum_X2 / nbSimulations - mean_X * mean_X;
+	double beta = var_X > 0 ? (sum_XY / nbSimulations - mean_X * mean_Y) / var_X : 0;
+	return df * (mean_Y - beta * mean_X) + beta * heston_model->price(&control);
+}
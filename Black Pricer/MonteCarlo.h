@@ -2,6 +2,8 @@
 #include <vector>
 #include "BlackScholesModel.h"
 #include "MultiAssetBSModel.h"
+#include "HestonModel.h"
+#include "Schedule.h"
 #include "Option.h"
 
 using namespace std;
@@ -10,20 +12,31 @@ using namespace std;
 	The Header file of the class "MonteCarlo".
 */
 
+double norm_variable(double mean = 0, double stddev = 1); // Normal distribution generator based on the Mersenne Twister algorithm.
+void norm_variables(float* normals, int n); // Block of n single precision standard normals, from the same generator.
+
 class MonteCarlo {
 private :
 	double nbSimulations; // Number of Simulations. Default : 20 000.
 	double nbSteps; // Number of Time steps. This attribute is only needed for path-dependent Options. Default : 1.
-	vector<double> timeSteps; // The time steps grid. This attribute is only needed for path-dependent Options.
+	bool singlePrecision = false; // Single precision paths for the BS and Multi-Asset BS prices. Default : false (double precision).
 public :
 	MonteCarlo(double nb_simulations = 20000, double time_steps = 1);
 	void setNbSimulations(double nbSimuls) { nbSimulations = nbSimuls; };
 	double getNbSimulations() { return nbSimulations; };
 	void setNbSteps(double steps) { nbSteps = steps; };
 	double getNbSteps() { return nbSteps; };
-	void setTimeSteps(Option* opt); // The "setTimeSteps" method calls the Option contract, and returns an equivalent time grid used for path simulations.
-	vector<double> getBSPath(BlackScholesModel* bs_model, Option* opt); // This method calls the BS model and the Option contract, and returns a simulated path of the spot price.
+	void setSinglePrecision(bool single) { singlePrecision = single; };
+	bool getSinglePrecision() { return singlePrecision; };
+	shared_ptr<const Schedule> getSchedule(Option* opt); // The "getSchedule" method calls the Option contract, and returns the equivalent cached time grid used for path simulations.
+	vector<double> getBSPath(BlackScholesModel* bs_model, Option* opt, const Schedule& schedule); // This method calls the BS model and the Option contract, and returns a simulated path of the spot price on the time grid.
 	vector<double> getBSPath(MultiAssetBSModel* bs_model, Option* opt); // This method calls the Multi-Asset BS model and the Option contract, and returns a simulated path of the spot price.
 	double price(BlackScholesModel* bs_model, Option* opt); // This method calls the BS model and the Option contract, and returns the equivalent BS Monte-Carlo price.
+	double priceSingle(BlackScholesModel* bs_model, Option* opt); // BS Monte-Carlo price on single precision paths, with a double precision accumulation of the payoffs.
+	void getMLMCSample(BlackScholesModel* bs_model, Option* opt, int level, const Schedule& schedule, double& fine_payoff, double& coarse_payoff); // This method simulates a pair of coupled fine and coarse paths of a MLMC level, and returns their payoffs.
+	double priceMLMC(BlackScholesModel* bs_model, Option* opt, double target_rmse, int max_level = 10); // This method returns the BS Multilevel Monte-Carlo price with a root mean square error close to "target_rmse".
 	double price(MultiAssetBSModel* bs_model, Option* opt); // This method calls the Multi-Asset BS model and the Option contract, and returns the equivalent BS Monte-Carlo price.
+	double priceSingle(MultiAssetBSModel* bs_model, Option* opt); // Multi-Asset BS Monte-Carlo price on single precision paths, with a double precision accumulation of the payoffs.
+	vector<double> getHestonPath(HestonModel* heston_model, Option* opt, const Schedule& schedule, double* survival = nullptr); // This method calls the Heston model and the Option contract, and returns a simulated path of the spot price on the time grid. "survival" receives the Brownian bridge survival probability of a monitored Barrier.
+	double price(HestonModel* heston_model, Option* opt, bool control_variate = true); // This method calls the Heston model and the Option contract, and returns the equivalent Heston Monte-Carlo price, with the semi-analytic Vanilla as control variate.
 };
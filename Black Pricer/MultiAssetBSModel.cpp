@@ -1,4 +1,6 @@
 #include "MultiAssetBSModel.h"
+#include "Numerics.h"
+#include "Instrumentation.h"
 #include <cmath>
 #include <algorithm>
 #include <numeric> 
@@ -9,13 +11,6 @@ using namespace std;
 	The Source file of the class "MultiAssetBSModel".
 */
 
-double std_normal_cum_func(double x) {
-
-	/* Standard Normal Distribution Cumulative function. */
-
-	return 0.5 + 0.5 * erf(x / pow(2, 0.5));
-}
-
 void MultiAssetBSModel::makeCorrDefPos(vector<vector<double>> correlations) {
 	/*
 		"makeCorrDefPos" method ensures that the correlation matrix is Definite Positive.
@@ -34,14 +29,14 @@ void MultiAssetBSModel::makeCorrDefPos(vector<vector<double>> correlations) {
 	setCorr(correlations);
 }
 
-double sum_squared(vector<double> vector, int end) {
+double sum_squared(const vector<double>& vector, int end) {
 	double result = 0;
 	for (int k = 0; k < end; k++)
 		result += pow(vector[k], 2);
 	return result;
 }
 
-double sum_product(vector<double> vector_1, vector<double> vector_2, int end) {
+double sum_product(const vector<double>& vector_1, const vector<double>& vector_2, int end) {
 	double result = 0;
 	for (int k = 0; k < end; k++)
 		result += vector_1[k] * vector_2[k];
@@ -66,18 +61,245 @@ void MultiAssetBSModel::CholeskyAlgo(vector<vector<double>> correlations) {
 	setCholeskyCorr(corrTriangInf);
 }
 
+static vector<double> gram_schmidt(vector<vector<double>>& Q) {
+
+	/* Modified Gram-Schmidt orthonormalization of the vectors Q[f] : returns their norms before normalization. */
+
+	vector<double> norms(Q.size());
+	for (size_t f = 0; f < Q.size(); f++) {
+		for (size_t g = 0; g < f; g++) {
+			double projection = inner_product(Q[f].begin(), Q[f].end(), Q[g].begin(), 0.);
+			for (size_t i = 0; i < Q[f].size(); i++)
+				Q[f][i] -= projection * Q[g][i];
+		}
+		norms[f] = sqrt(inner_product(Q[f].begin(), Q[f].end(), Q[f].begin(), 0.));
+		for (double& q : Q[f])
+			q = norms[f] > 0 ? q / norms[f] : 0;
+	}
+	return norms;
+}
+
+static void multiply(const vector<vector<double>>& C, const vector<vector<double>>& Q, vector<vector<double>>& Z) {
+
+	/* Z[f] = C Q[f] for every vector Q[f]. */
+
+	for (size_t i = 0; i < C.size(); i++)
+		for (size_t f = 0; f < Q.size(); f++)
+			Z[f][i] = inner_product(C[i].begin(), C[i].end(), Q[f].begin(), 0.);
+}
+
+void MultiAssetBSModel::FactorAlgo(int nb_factors) {
+	/*
+		k-factor approximation of the correlation matrix : corr ~ L L' + diag(1 - |L_i|^2), with L a d x k matrix.
+		The loadings are fitted by principal axis factoring : L spans the k leading eigenvectors of the correlation matrix whose diagonal is replaced
+		by the communalities |L_i|^2. Starting from a unit diagonal (the PCA truncation), every pass makes one orthogonal iteration Q <- orth(C Q),
+		in O(d^2 k), sets L = Q G with G the Cholesky factor of Q' C Q (so that L L' = Q Q' C Q Q'), and updates the communalities : the eigenvectors
+		and the diagonal converge together, and the idiosyncratic variances stop weighing on the fitted correlations.
+		The simulations and the Basket moments then cost O(d k) instead of O(d^2). The errors of the approximated correlations are kept in
+		"factorMaxError" and "factorRMSError".
+	*/
+	int n = (int)d;
+	int k = nb_factors;
+	nbFactors = 0;
+	factor_loadings.clear();
+	idiosyncratic_vol.clear();
+	factorMaxError = 0;
+	factorRMSError = 0;
+	if (k <= 0 || k >= n)
+		return;
+
+	// Start of the orthogonal iterations : the equally weighted portfolio, and deterministic pseudo-random directions
+	vector<vector<double>> Q(k, vector<double>(n, 1));
+	vector<vector<double>> Z(k, vector<double>(n));
+	unsigned int seed = 12345;
+	for (int f = 1; f < k; f++)
+		for (int i = 0; i < n; i++) {
+			seed = seed * 1664525 + 1013904223;
+			Q[f][i] = seed / 4294967296.0 - 0.5;
+		}
+	gram_schmidt(Q);
+
+	vector<vector<double>> reduced = def_pos_corr; // Correlation matrix with the communalities on its diagonal.
+	vector<vector<double>> G(k, vector<double>(k));
+	factor_loadings = vector<vector<double>>(n, vector<double>(k));
+	double previous_trace = 0;
+	for (int pass = 0; pass < 500; pass++) {
+		multiply(reduced, Q, Z);
+		gram_schmidt(Z);
+		Q.swap(Z);
+
+		// L = Q G, with G G' = Q' C Q
+		multiply(reduced, Q, Z);
+		for (int f = 0; f < k; f++)
+			for (int g = 0; g <= f; g++) {
+				double h = inner_product(Q[f].begin(), Q[f].end(), Z[g].begin(), 0.) - sum_product(G[f], G[g], g);
+				G[f][g] = f == g ? sqrt(max(h, 0.)) : (G[g][g] > 0 ? h / G[g][g] : 0);
+			}
+		double trace = 0; // Variance captured by the factors : stable once the subspace and the communalities have converged.
+		for (int f = 0; f < k; f++)
+			trace += inner_product(Q[f].begin(), Q[f].end(), Z[f].begin(), 0.);
+		for (int i = 0; i < n; i++) {
+			for (int f = 0; f < k; f++) {
+				factor_loadings[i][f] = 0;
+				for (int g = f; g < k; g++)
+					factor_loadings[i][f] += Q[g][i] * G[g][f];
+			}
+			reduced[i][i] = min(sum_squared(factor_loadings[i], k), 1.);
+		}
+		if (fabs(trace - previous_trace) < 1e-8 * trace)
+			break;
+		previous_trace = trace;
+	}
+
+	idiosyncratic_vol = vector<double>(n);
+	for (int i = 0; i < n; i++)
+		idiosyncratic_vol[i] = sqrt(max(1 - sum_squared(factor_loadings[i], k), 0.));
+	nbFactors = k;
+
+	// Errors of the approximated correlations
+	double sum_errors = 0;
+	for (int i = 0; i < n; i++)
+		for (int j = i + 1; j < n; j++) {
+			double error = fabs(def_pos_corr[i][j] - inner_product(factor_loadings[i].begin(), factor_loadings[i].end(), factor_loadings[j].begin(), 0.));
+			factorMaxError = max(factorMaxError, error);
+			sum_errors += error * error;
+		}
+	factorRMSError = sqrt(sum_errors / (n * (n - 1) / 2.));
+}
+
+static void expand_moment(const vector<vector<double>>& u, const vector<double>& beta, int max_order, int order, int last, int multiplicity, double coefficient,
+	vector<vector<double>>& monomials, double& sum) {
+	/*
+		Terms of the multinomial expansion of sum_{i != j} beta_i beta_j (u_i.u_j)^n / n!, for the orders order + 1 to max_order.
+		The order n term is the sum over the multi-indices a of size n of (sum_i beta_i u_i^a)^2 / a!, minus its diagonal sum_i (beta_i u_i^a)^2 / a!.
+		The multi-indices are enumerated as non-decreasing sequences of factors : "monomials[order]" holds u_i^a for the current prefix.
+	*/
+	int n = (int)beta.size();
+	int k = (int)u[0].size();
+	for (int f = last; f < k; f++) {
+		int m = f == last ? multiplicity + 1 : 1;
+		double c = coefficient / m;
+		vector<double>& monomial = monomials[order + 1];
+		double s = 0, diagonal = 0;
+		for (int i = 0; i < n; i++) {
+			monomial[i] = monomials[order][i] * u[i][f];
+			double term = beta[i] * monomial[i];
+			s += term;
+			diagonal += term * term;
+		}
+		sum += c * (s * s - diagonal);
+		if (order + 1 < max_order)
+			expand_moment(u, beta, max_order, order + 1, f, m, c, monomials, sum);
+	}
+}
+
+double MultiAssetBSModel::factorSecondMoment(const vector<double>& beta, double T) {
+	/*
+		Second moment sum_ij beta_i beta_j exp(sigma_i sigma_j corr_ij T) of the Basket under the factor model.
+		With u_i = sigma_i sqrt(T) L_i, the off-diagonal terms are exp(u_i.u_j). Their exponential series is summed in the factor space up to the order N
+		where the remainder falls under 1e-12 (relative to the squared first moment) : C(k + N, N) sums over the d underlyings instead of d^2 exponentials.
+		When the expansion would cost more (large k, or large variances), the off-diagonal terms are summed exactly.
+	*/
+	int n = (int)d;
+	int k = (int)nbFactors;
+	vector<vector<double>> u(n, vector<double>(k));
+	double max_u2 = 0, diagonal = 0, sum_beta = 0, sum_beta2 = 0;
+	for (int i = 0; i < n; i++) {
+		for (int f = 0; f < k; f++)
+			u[i][f] = sigma[i] * sqrt(T) * factor_loadings[i][f];
+		max_u2 = max(max_u2, sum_squared(u[i], k));
+		diagonal += beta[i] * beta[i] * exp(sigma[i] * sigma[i] * T);
+		sum_beta += beta[i];
+		sum_beta2 += beta[i] * beta[i];
+	}
+
+	// Order of the expansion : |u_i.u_j| <= max |u_i|^2, and the remainder of exp(x) after the order N is below x^(N+1) / (N+1)! exp(x)
+	int order = 0;
+	double remainder = exp(max_u2), nb_terms = 0, nb_terms_order = 1;
+	while (remainder > 1e-12 && nb_terms <= n) {
+		order++;
+		remainder *= max_u2 / (order + 1);
+		nb_terms_order *= (k + order - 1.) / order;
+		nb_terms += nb_terms_order;
+	}
+
+	if (nb_terms > n) {
+		double off_diagonal = 0;
+		for (int i = 0; i < n; i++)
+			for (int j = i + 1; j < n; j++)
+				off_diagonal += 2 * beta[i] * beta[j] * exp(inner_product(u[i].begin(), u[i].end(), u[j].begin(), 0.));
+		return diagonal + off_diagonal;
+	}
+
+	vector<vector<double>> monomials(order + 1, vector<double>(n, 1));
+	double off_diagonal = sum_beta * sum_beta - sum_beta2;
+	expand_moment(u, beta, order, 0, 0, 0, 1, monomials, off_diagonal);
+	return diagonal + off_diagonal;
+}
+
 vector<double> MultiAssetBSModel::simulation(vector<double> prev_S, double dt, vector<double> rnd_normal) {
 	/*
 		Spot price simulation between t and t + dt under the BS model. 
-		The correlations are handled by the Cholesky Decomposition output. 
+		The correlations are handled by the Cholesky Decomposition output, or by the factor model : the k first normals drive the factors,
+		and the d next ones the idiosyncratic moves of the underlyings.
 	*/
 	vector<double> next_S;
-	for (int i = 0; i < d; i++) 
-		next_S.push_back(prev_S[i] * exp((r - pow(sigma[i], 2) / 2) * dt + sigma[i] * pow(dt, 0.5) * sum_product(cholesky_corr[i], rnd_normal, d)));
+	next_S.reserve(d);
+	for (int i = 0; i < d; i++) {
+		double correlated_normal;
+		if (nbFactors > 0) {
+			correlated_normal = idiosyncratic_vol[i] * rnd_normal[nbFactors + i];
+			for (int f = 0; f < nbFactors; f++)
+				correlated_normal += factor_loadings[i][f] * rnd_normal[f];
+		}
+		else
+			correlated_normal = sum_product(cholesky_corr[i], rnd_normal, d);
+		next_S.push_back(prev_S[i] * exp((r - pow(sigma[i], 2) / 2) * dt + sigma[i] * pow(dt, 0.5) * correlated_normal));
+	}
 	
 	return next_S;
 }
 
+void MultiAssetBSModel::simulation(float* S_t, const float* rnd_normal, int n, double dt) {
+	/*
+		Single precision simulation of n paths between t and t + dt. The spots and the independent normals are stored one after the other :
+		S_t[i * n + j] for the underlying i of the path j, and rnd_normal[l * n + j] for the normal l of the path j, so every loop runs over the paths.
+		The normals are ordered as in the double precision simulation.
+	*/
+	static thread_local vector<float> correlated; // Correlated normals of the underlying, reused by every call of the thread.
+	if ((size_t)n > correlated.capacity())
+		PRICER_COUNT_ALLOCATIONS(1);
+	correlated.resize(n);
+	for (int i = 0; i < d; i++) {
+		if (nbFactors > 0) {
+			float c = (float)idiosyncratic_vol[i];
+			const float* z = rnd_normal + (int)(nbFactors + i) * n;
+			for (int j = 0; j < n; j++)
+				correlated[j] = c * z[j];
+			for (int f = 0; f < nbFactors; f++) {
+				c = (float)factor_loadings[i][f];
+				z = rnd_normal + f * n;
+				for (int j = 0; j < n; j++)
+					correlated[j] += c * z[j];
+			}
+		}
+		else {
+			fill(correlated.begin(), correlated.end(), 0.f);
+			for (int k = 0; k <= i; k++) {
+				float c = (float)cholesky_corr[i][k];
+				const float* z = rnd_normal + k * n;
+				for (int j = 0; j < n; j++)
+					correlated[j] += c * z[j];
+			}
+		}
+		float drift = (float)((r - sigma[i] * sigma[i] / 2) * dt);
+		float diffusion = (float)(sigma[i] * sqrt(dt));
+		float* S = S_t + i * n;
+		for (int j = 0; j < n; j++)
+			S[j] *= exp(drift + diffusion * correlated[j]);
+	}
+}
+
 BlackBasket::BlackBasket(double rate, double size, vector<double> spot, vector<double> vol, vector<vector<double>> correlations) {
 	
 	/* BS Basket constructor. */
@@ -100,12 +322,23 @@ double BlackBasket::price(Option* opt) {
 	double m1 = 0;
 	double m2 = 0;
 
-	for (int i = 0; i < d; i++) {
-		beta1 = S[i] * exp(r * T) / d;
-		m1 += beta1;
-		for (int j = 0; j < d; j++) {
-			beta2 = S[j] * exp(r * T) / d;
-			m2 += beta1 * beta2 * exp(sigma[i] * sigma[j] * def_pos_corr[i][j] * T);
+	if (nbFactors > 0) {
+		// Factor model : O(d k) moments
+		vector<double> beta(d);
+		for (int i = 0; i < d; i++) {
+			beta[i] = S[i] * exp(r * T) / d;
+			m1 += beta[i];
+		}
+		m2 = factorSecondMoment(beta, T);
+	}
+	else {
+		for (int i = 0; i < d; i++) {
+			beta1 = S[i] * exp(r * T) / d;
+			m1 += beta1;
+			for (int j = 0; j < d; j++) {
+				beta2 = S[j] * exp(r * T) / d;
+				m2 += beta1 * beta2 * exp(sigma[i] * sigma[j] * def_pos_corr[i][j] * T);
+			}
 		}
 	}
 
@@ -113,7 +346,7 @@ double BlackBasket::price(Option* opt) {
 	double d1 = (log(m1 / K) + log(m2 / pow(m1, 2)) / 2) / pow(log(m2 / pow(m1, 2)), 0.5);
 	double d2 = d1 - pow(log(m2 / pow(m1, 2)), 0.5);
 	double phi = opt->getPhi();
-	return df * (phi * m1 * std_normal_cum_func(phi * d1) - phi * K * std_normal_cum_func(phi * d2));
+	return df * (phi * m1 * std_normal_cum(phi * d1) - phi * K * std_normal_cum(phi * d2));
 }
 
 BlackSpread::BlackSpread(double rate, vector<double> spot, vector<double> vol, vector<vector<double>> correlations) {
@@ -128,11 +361,13 @@ BlackSpread::BlackSpread(double rate, vector<double> spot, vector<double> vol, v
 }
 
 double BlackSpread::price(Option* opt) {
+	return price(opt->getStrike(), opt->getMaturity(), opt->getPhi());
+}
+
+double BlackSpread::price(double K, double T, int phi) {
 	
 	/* BS Spread price : BS formula based on the Kirks approximation & Margrabe's method. */
 
-	double T = opt->getMaturity();
-	double K = opt->getStrike();
 	double df = exp(-r * T);
 	double corr = def_pos_corr[0][1];
 	double S1_adj = S[1] + K * df;
@@ -141,6 +376,139 @@ double BlackSpread::price(Option* opt) {
 	
 	double d1 = (log(S[0] / S1_adj) + pow(vol, 2) * T / 2) / (vol * pow(T, 0.5));
 	double d2 = d1 - vol * pow(T, 0.5);
-	double phi = opt->getPhi();
-	return phi * S[0] * std_normal_cum_func(phi * d1) - phi * S1_adj *std_normal_cum_func(phi * d2);
+	return phi * S[0] * std_normal_cum(phi * d1) - phi * S1_adj *std_normal_cum(phi * d2);
+}
+
+double BlackSpread::priceQuadrature(Option* opt, int nb_nodes) {
+	return priceQuadrature(opt->getStrike(), opt->getMaturity(), opt->getPhi(), nb_nodes);
+}
+
+double BlackSpread::priceQuadrature(double K, double T, int phi, int nb_nodes) {
+	double price;
+	priceQuadrature(&K, &price, 1, T, phi, nb_nodes);
+	return price;
+}
+
+static double normal_mass(double lo, double hi, double shift) {
+
+	/* N(hi - shift) - N(lo - shift), taken in the upper tail when the interval lies above the shift, where the difference would cancel. */
+
+	if (lo > shift)
+		return std_normal_cum(shift - lo) - std_normal_cum(shift - hi);
+	return std_normal_cum(hi - shift) - std_normal_cum(lo - shift);
+}
+
+static double exercise_root(double A, double p_A, double B, double p_B, double K, double lo, double hi, bool increasing, double start) {
+	/*
+		Root of f(u) = A exp(p_A u) - B exp(p_B u) - K in [lo, hi], where f is monotone and changes sign : Newton steps from "start" (or 0) when it
+		lies in the bracket, bisection when they leave it. The price only moves with the square of the error on the root, where the payoff vanishes,
+		and the Newton steps converge quadratically : the search stops at a step of 1e-9.
+	*/
+	double u = start > lo && start < hi ? start : min(max(0., lo), hi);
+	for (int i = 0; i < 200; i++) {
+		double e_A = A * exp(p_A * u);
+		double e_B = B * exp(p_B * u);
+		double f = e_A - e_B - K;
+		if ((f > 0) == increasing)
+			hi = u;
+		else
+			lo = u;
+		double next = u - f / (p_A * e_A - p_B * e_B);
+		if (!(next > lo && next < hi))
+			next = (lo + hi) / 2;
+		if (fabs(next - u) <= 1e-9 * (1 + fabs(u)))
+			return next;
+		u = next;
+	}
+	return u;
+}
+
+static double conditional_spread(double A, double p_A, double B, double p_B, double K, int phi, double& root) {
+	/*
+		E[max(phi (A exp(p_A U) - B exp(p_B U) - K), 0)] for a standard normal U. f(u) = A exp(p_A u) - B exp(p_B u) - K has at most one extremum, so at most
+		two roots, where f changes sign : on each interval [lo, hi] between them where phi f is positive, the expectation is A exp(p_A^2 / 2) (N(hi - p_A)
+		- N(lo - p_A)) - B exp(p_B^2 / 2) (N(hi - p_B) - N(lo - p_B)) - K (N(hi) - N(lo)). The line is cut at +-L, beyond which the three terms vanish.
+		"root" starts the search of the roots, and returns the last one found : the roots move little from one quadrature node to the next.
+	*/
+	double L = 40 + max(fabs(p_A), fabs(p_B));
+	double ends[3] = { -L, L, L };
+	int nb_ends = 2;
+	if (p_A * p_B > 0 && p_A != p_B) {
+		double extremum = log(B * p_B / (A * p_A)) / (p_A - p_B);
+		if (extremum > -L && extremum < L) {
+			ends[1] = extremum;
+			nb_ends = 3;
+		}
+	}
+	bool positive[3];
+	for (int i = 0; i < nb_ends; i++)
+		positive[i] = A * exp(p_A * ends[i]) - B * exp(p_B * ends[i]) - K > 0;
+	double cuts[4] = { -L };
+	int nb_cuts = 1;
+	for (int i = 0; i + 1 < nb_ends; i++)
+		if (positive[i] != positive[i + 1])
+			cuts[nb_cuts++] = root = exercise_root(A, p_A, B, p_B, K, ends[i], ends[i + 1], positive[i + 1], root);
+	cuts[nb_cuts++] = L;
+
+	double price = 0;
+	bool exercised = positive[0] == (phi > 0);
+	for (int i = 0; i + 1 < nb_cuts; i++, exercised = !exercised) {
+		double lo = cuts[i], hi = cuts[i + 1];
+		if (exercised)
+			price += phi * (A * exp(p_A * p_A / 2) * normal_mass(lo, hi, p_A) - B * exp(p_B * p_B / 2) * normal_mass(lo, hi, p_B) - K * normal_mass(lo, hi, 0));
+	}
+	return price;
+}
+
+void BlackSpread::priceQuadrature(const double* K, double* prices, int n, double T, int phi, int nb_nodes) {
+	/*
+		BS Spread prices of the strikes K[0..n). The two Brownian motions are written with two independent standard normals U and V, U along the normal
+		of the exercise boundary S1_T - S2_T = K at the forward of the second underlying. Given V, both underlyings are exponentials of U, and the price
+		is a sum of log-normal partial expectations between the roots of the payoff (see "conditional_spread"). Its expectation over V is computed with
+		a Gauss-Hermite quadrature of "nb_nodes" nodes. Since U crosses the exercise boundary, the conditional price is smooth in V for any correlation,
+		where conditioning on one underlying leaves a kink of width sigma1 sqrt(1 - rho^2) that the nodes cannot resolve for negative correlations.
+		A negative strike is the Put of the exchanged underlyings with the strike -K, whose boundary bends the same way as the positive strikes.
+		16 nodes reach 1e-9 and 32 nodes 1e-11 on the usual contracts, for any correlation. Large total volatilities (sigma sqrt(T) near 1 and above)
+		converge more slowly, to 1e-4 relative with 32 nodes on the strikes far from the money. "nb_nodes" is capped to 128, beyond which the nodes lose their accuracy.
+	*/
+	nb_nodes = min(max(nb_nodes, 1), 128);
+	static thread_local vector<double> nodes, weights; // Quadrature of the thread, recomputed when "nb_nodes" changes.
+	if ((int)nodes.size() != nb_nodes) {
+		nodes.resize(nb_nodes);
+		weights.resize(nb_nodes);
+		gauss_hermite(nb_nodes, nodes.data(), weights.data());
+	}
+
+	double rho = def_pos_corr[0][1];
+	double s = pow(max(1 - rho * rho, 0.), 0.5);
+	double sqrt_T = pow(T, 0.5);
+	double df = exp(-r * T);
+	for (int j = 0; j < n; j++) {
+		bool exchanged = K[j] < 0;
+		int first = exchanged ? 1 : 0, second = 1 - first;
+		double strike = fabs(K[j]);
+		int psi = exchanged ? -phi : phi;
+		double a = sigma[first] * sqrt_T;
+		double b = sigma[second] * sqrt_T;
+
+		// Normal of the exercise boundary at S2_T = S2, in the coordinates (Z2, Z_perp) of W2 = Z2, W1 = rho Z2 + sqrt(1 - rho^2) Z_perp
+		double n1 = (S[second] + strike) * a * rho - S[second] * b;
+		double n2 = (S[second] + strike) * a * s;
+		double norm = pow(n1 * n1 + n2 * n2, 0.5);
+		if (norm > 0)
+			n1 /= norm, n2 /= norm;
+		else
+			n1 = 1, n2 = 0;
+		double p_A = a * (rho * n1 + s * n2), q_A = a * (s * n1 - rho * n2);
+		double p_B = b * n1, q_B = -b * n2;
+
+		double price = 0, root = 0;
+		for (int i = 0; i < nb_nodes; i++) {
+			double V = pow(2, 0.5) * nodes[i];
+			double A = S[first] * exp(r * T - a * a / 2 + q_A * V);
+			double B = S[second] * exp(r * T - b * b / 2 + q_B * V);
+			price += weights[i] / pow(3.14159265358979323846, 0.5) * conditional_spread(A, p_A, B, p_B, strike, psi, root);
+		}
+		prices[j] = df * price;
+	}
 }
\ No newline at end of file
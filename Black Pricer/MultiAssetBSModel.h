@@ -15,6 +15,12 @@ protected :
 	double d; // The Underlyings basket size.
 	vector<vector<double>> def_pos_corr; // Definite Positive Correlation Matrix.
 	vector<vector<double>> cholesky_corr; // Lower Triangular Matrix : Output of the Cholesky Decomposition Algorithm.
+	double nbFactors = 0; // Number of factors of the correlation model. Default : 0, the full Cholesky correlation.
+	vector<vector<double>> factor_loadings; // d x k Matrix L of the factor model : corr ~ L L' off the diagonal.
+	vector<double> idiosyncratic_vol; // sqrt(1 - |L_i|^2) : weight of the own normal of the underlying i, so that the correlations keep a unit diagonal.
+	double factorMaxError = 0; // Largest absolute error of the factor model correlations.
+	double factorRMSError = 0; // Root mean square error of the factor model correlations, off the diagonal.
+	double factorSecondMoment(const vector<double>& beta, double T); // Second moment of the Basket of weights "beta" under the factor model.
 public:
 	void setSize(double size) { d = size; };
 	double getSize() { return d; };
@@ -30,7 +36,14 @@ public:
 	vector<vector<double>> getCholeskyCorr() { return cholesky_corr; };
 	void CholeskyAlgo(vector<vector<double>> correlations); // Cholesky Decomposition Algorithm.
 	void makeCorrDefPos(vector<vector<double>> correlations); // The "makeCorrDefPos" method ensures that the correlation matrix is Definite Positive.
-	vector<double> simulation(vector<double> prev_S, double dt, vector<double> rnd_normal); // The simulation method is called in the "MonteCarlo" class.
+	void FactorAlgo(int nb_factors); // k-factor approximation of the correlation matrix : PCA truncation with idiosyncratic terms. 0 (or k >= d) restores the full Cholesky correlation.
+	double getNbFactors() { return nbFactors; };
+	vector<vector<double>> getFactorLoadings() { return factor_loadings; };
+	double getFactorMaxError() { return factorMaxError; };
+	double getFactorRMSError() { return factorRMSError; };
+	int getNbNormals() { return (int)(d + nbFactors); }; // Independent normals per simulation : one per underlying, plus one per factor.
+	vector<double> simulation(vector<double> prev_S, double dt, vector<double> rnd_normal); // The simulation method is called in the "MonteCarlo" class, with "getNbNormals" normals.
+	void simulation(float* S_t, const float* rnd_normal, int n, double dt); // Single precision simulation of n paths : the spot of the underlying i on the path j is S_t[i * n + j], updated in place.
 	virtual double price(Option* opt) = 0; // The BS price is a pure virtual method.
 };
 
@@ -47,4 +60,8 @@ class BlackSpread : public MultiAssetBSModel {
 public:
 	BlackSpread(double rate, vector<double> spot, vector<double> vol, vector<vector<double>> corr_matrix);
 	double price(Option* opt);
+	double price(double K, double T, int phi); // Kirk's price of the contract terms, without an Option.
+	double priceQuadrature(Option* opt, int nb_nodes = 32); // Spread price by Gauss-Hermite quadrature, integrated exactly across the exercise boundary.
+	double priceQuadrature(double K, double T, int phi, int nb_nodes = 32);
+	void priceQuadrature(const double* K, double* prices, int n, double T, int phi, int nb_nodes = 32); // Quadrature prices of the n strikes K[0..n), sharing the nodes.
 };
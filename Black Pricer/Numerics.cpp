@@ -0,0 +1,341 @@
+#include "Numerics.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+/*
+	The Source file of the "Numerics" functions.
+*/
+
+const double PI = 3.14159265358979323846;
+const double INV_SQRT_2PI = 0.39894228040143267794;
+
+double std_normal_pdf(double x) {
+
+	/* Standard Normal Density function. */
+
+	return INV_SQRT_2PI * exp(-0.5 * x * x);
+}
+
+double std_normal_cum(double x) {
+	/*
+		Standard Normal Cumulative function.
+		West (2005), "Better approximations to cumulative normal functions" : double precision version of Hart's algorithm 5666.
+	*/
+	double x_abs = fabs(x);
+	double c = 0;
+
+	if (x_abs <= 37) {
+		double e = exp(-x_abs * x_abs / 2);
+		if (x_abs < 7.07106781186547) {
+			double num = 3.52624965998911E-02 * x_abs + 0.700383064443688;
+			num = num * x_abs + 6.37396220353165;
+			num = num * x_abs + 33.912866078383;
+			num = num * x_abs + 112.079291497871;
+			num = num * x_abs + 221.213596169931;
+			num = num * x_abs + 220.206867912376;
+			double den = 8.83883476483184E-02 * x_abs + 1.75566716318264;
+			den = den * x_abs + 16.064177579207;
+			den = den * x_abs + 86.7807322029461;
+			den = den * x_abs + 296.564248779674;
+			den = den * x_abs + 637.333633378831;
+			den = den * x_abs + 793.826512519948;
+			den = den * x_abs + 440.413735824752;
+			c = e * num / den;
+		}
+		else {
+			// Continued fraction for the tail
+			double cf = x_abs + 0.65;
+			cf = x_abs + 4 / cf;
+			cf = x_abs + 3 / cf;
+			cf = x_abs + 2 / cf;
+			cf = x_abs + 1 / cf;
+			c = e / cf / 2.506628274631;
+		}
+	}
+
+	return x > 0 ? 1 - c : c;
+}
+
+double std_normal_cum_fast(double x) {
+	/*
+		Standard Normal Cumulative function.
+		Abramowitz & Stegun 26.2.17 : a single branch-free polynomial, so that the array version is vectorized.
+	*/
+	double x_abs = fabs(x);
+	double t = 1 / (1 + 0.2316419 * x_abs);
+	double poly = t * (0.319381530 + t * (-0.356563782 + t * (1.781477937 + t * (-1.821255978 + t * 1.330274429))));
+	double c = INV_SQRT_2PI * exp_fast(-0.5 * x_abs * x_abs) * poly;
+	return x >= 0 ? 1 - c : c;
+}
+
+double std_normal_inv(double p) {
+	/*
+		Standard Normal inverse Cumulative function.
+		Wichura (1988), Algorithm AS241 "The percentage points of the normal distribution" : PPND16.
+	*/
+	if (p <= 0)
+		return -HUGE_VAL;
+	if (p >= 1)
+		return HUGE_VAL;
+
+	double q = p - 0.5;
+	double r, value;
+
+	if (fabs(q) <= 0.425) {
+		r = 0.180625 - q * q;
+		return q * (((((((r * 2509.0809287301226727 + 33430.575583588128105) * r + 67265.770927008700853) * r
+			+ 45921.953931549871457) * r + 13731.693765509461125) * r + 1971.5909503065514427) * r
+			+ 133.14166789178437745) * r + 3.387132872796366608)
+			/ (((((((r * 5226.495278852545925 + 28729.085735721942674) * r + 39307.89580009271061) * r
+			+ 21213.794301586595867) * r + 5394.1960214247511077) * r + 687.1870074920579083) * r
+			+ 42.313330701600911252) * r + 1);
+	}
+
+	r = q < 0 ? p : 1 - p;
+	r = sqrt(-log(r));
+
+	if (r <= 5) {
+		r -= 1.6;
+		value = (((((((r * 7.7454501427834140764e-4 + 0.0227238449892691845833) * r + 0.24178072517745061177) * r
+			+ 1.27045825245236838258) * r + 3.64784832476320460504) * r + 5.7694972214606914055) * r
+			+ 4.6303378461565452959) * r + 1.42343711074968357734)
+			/ (((((((r * 1.05075007164441684324e-9 + 5.475938084995344946e-4) * r + 0.0151986665636164571966) * r
+			+ 0.14810397642748007459) * r + 0.68976733498510000455) * r + 1.6763848301838038494) * r
+			+ 2.05319162663775882187) * r + 1);
+	}
+	else {
+		r -= 5;
+		value = (((((((r * 2.01033439929228813265e-7 + 2.71155556874348757815e-5) * r + 0.0012426609473880784386) * r
+			+ 0.026532189526576123093) * r + 0.29656057182850489123) * r + 1.7848265399172913358) * r
+			+ 5.4637849111641143699) * r + 6.6579046435011037772)
+			/ (((((((r * 2.04426310338993978564e-15 + 1.4215117583164458887e-7) * r + 1.8463183175100546818e-5) * r
+			+ 7.868691311456132591e-4) * r + 0.0148753612908506148525) * r + 0.13692988092273580531) * r
+			+ 0.59983220655588793769) * r + 1);
+	}
+
+	return q < 0 ? -value : value;
+}
+
+double std_normal_inv_fast(double p) {
+	/*
+		Standard Normal inverse Cumulative function.
+		Acklam (2003) : rational approximations on the central region and on the tails.
+	*/
+	const double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	const double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	const double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	const double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+	const double p_low = 0.02425;
+
+	if (p < p_low) {
+		double q = sqrt(-2 * log(p));
+		return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+	}
+	if (p > 1 - p_low) {
+		double q = sqrt(-2 * log(1 - p));
+		return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+	}
+	double q = p - 0.5;
+	double r = q * q;
+	return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+double bivariate_normal_cum(double x, double y, double rho) {
+	/*
+		Bivariate Standard Normal Cumulative function P(X < x, Y < y) with correlation rho.
+		Genz (2004), "Numerical computation of rectangular bivariate and trivariate normal and t probabilities" : BVND.
+		BVND computes P(X > h, Y > k), hence h = -x and k = -y.
+		Gauss-Legendre quadrature with 6, 12 or 20 points depending on |rho|.
+	*/
+	const double w[3][10] = {
+		{ 0.1713244923791705, 0.3607615730481384, 0.4679139345726904 },
+		{ 0.04717533638651177, 0.1069393259953183, 0.1600783285433464, 0.2031674267230659, 0.2334925365383547, 0.2491470458134029 },
+		{ 0.01761400713915212, 0.04060142980038694, 0.06267204833410906, 0.08327674157670475, 0.1019301198172404,
+		  0.1181945319615184, 0.1316886384491766, 0.1420961093183821, 0.1491729864726037, 0.1527533871307259 } };
+	const double gl[3][10] = {
+		{ -0.9324695142031522, -0.6612093864662647, -0.2386191860831970 },
+		{ -0.9815606342467191, -0.9041172563704750, -0.7699026741943050, -0.5873179542866171, -0.3678314989981802, -0.1252334085114692 },
+		{ -0.9931285991850949, -0.9639719272779138, -0.9122344282513259, -0.8391169718222188, -0.7463319064601508,
+		  -0.6360536807265150, -0.5108670019508271, -0.3737060887154196, -0.2277858511416451, -0.07652652113349733 } };
+
+	int ng, lg;
+	if (fabs(rho) < 0.3) {
+		ng = 0;
+		lg = 3;
+	}
+	else if (fabs(rho) < 0.75) {
+		ng = 1;
+		lg = 6;
+	}
+	else {
+		ng = 2;
+		lg = 10;
+	}
+
+	double h = -x;
+	double k = -y;
+	double hk = h * k;
+	double bvn = 0;
+
+	if (fabs(rho) < 0.925) {
+		double hs = (h * h + k * k) / 2;
+		double asr = asin(rho);
+		for (int i = 0; i < lg; i++) {
+			double sn = sin(asr * (gl[ng][i] + 1) / 2);
+			bvn += w[ng][i] * exp((sn * hk - hs) / (1 - sn * sn));
+			sn = sin(asr * (-gl[ng][i] + 1) / 2);
+			bvn += w[ng][i] * exp((sn * hk - hs) / (1 - sn * sn));
+		}
+		return bvn * asr / (4 * PI) + std_normal_cum(-h) * std_normal_cum(-k);
+	}
+
+	if (rho < 0) {
+		k = -k;
+		hk = -hk;
+	}
+
+	if (fabs(rho) < 1) {
+		double as = (1 - rho) * (1 + rho);
+		double a = sqrt(as);
+		double bs = pow(h - k, 2);
+		double c = (4 - hk) / 8;
+		double d = (12 - hk) / 16;
+		bvn = a * exp(-(bs / as + hk) / 2) * (1 - c * (bs - as) * (1 - d * bs / 5) / 3 + c * d * as * as / 5);
+		if (hk > -160) {
+			double b = sqrt(bs);
+			bvn -= exp(-hk / 2) * sqrt(2 * PI) * std_normal_cum(-b / a) * b * (1 - c * bs * (1 - d * bs / 5) / 3);
+		}
+		a /= 2;
+		for (int i = 0; i < lg; i++) {
+			for (int is = -1; is <= 1; is += 2) {
+				double xs = pow(a * (is * gl[ng][i] + 1), 2);
+				double rs = sqrt(1 - xs);
+				bvn += a * w[ng][i] * (exp(-bs / (2 * xs) - hk / (1 + rs)) / rs - exp(-(bs / xs + hk) / 2) * (1 + c * xs * (1 + d * xs)));
+			}
+		}
+		bvn = -bvn / (2 * PI);
+	}
+
+	if (rho > 0)
+		return bvn + std_normal_cum(-max(h, k));
+	bvn = -bvn;
+	if (k > h)
+		bvn += std_normal_cum(k) - std_normal_cum(h);
+	return bvn;
+}
+
+double exp_fast(double x) {
+	/*
+		Exponential : exp(x) = 2^n * exp(r) with n = round(x / ln(2)) and |r| <= ln(2) / 2.
+		ln(2) is split in two parts (Cody-Waite) so that r is exact, and exp(r) is a degree 13 Taylor polynomial.
+		The input is clamped to [-708, 709] : no NaN, infinity or subnormal handling.
+	*/
+	const double ln2_hi = 6.93147180369123816490e-01;
+	const double ln2_lo = 1.90821492927058770002e-10;
+	const double inv_ln2 = 1.44269504088896338700;
+
+	x = x < -708 ? -708 : x;
+	x = x > 709 ? 709 : x;
+
+	// Rounding with the 1.5 * 2^52 shifter : the low mantissa bits of "shifted" hold n as an integer
+	double shifted = x * inv_ln2 + 6755399441055744.0;
+	double n = shifted - 6755399441055744.0;
+	double r = (x - n * ln2_hi) - n * ln2_lo;
+
+	double poly = 1. / 6227020800;
+	poly = poly * r + 1. / 479001600;
+	poly = poly * r + 1. / 39916800;
+	poly = poly * r + 1. / 3628800;
+	poly = poly * r + 1. / 362880;
+	poly = poly * r + 1. / 40320;
+	poly = poly * r + 1. / 5040;
+	poly = poly * r + 1. / 720;
+	poly = poly * r + 1. / 120;
+	poly = poly * r + 1. / 24;
+	poly = poly * r + 1. / 6;
+	poly = poly * r + 0.5;
+	poly = poly * r + 1;
+	poly = poly * r + 1;
+
+	// 2^n built from its IEEE-754 exponent bits
+	uint64_t bits;
+	memcpy(&bits, &shifted, sizeof(bits));
+	bits = (bits + 1023) << 52; // Unsigned : the bits above the exponent field are shifted out.
+	double scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return poly * scale;
+}
+
+void gauss_hermite(int n, double* nodes, double* weights) {
+	/*
+		Nodes and weights of the n-point Gauss-Hermite quadrature : the integral of exp(-x^2) f(x) is close to sum_i weights[i] f(nodes[i]).
+		The positive roots of the Hermite polynomial H_n are refined by Newton iterations on the normalized recurrence, from the asymptotic
+		initial guesses of Numerical Recipes (gauher), and mirrored. The weights are 2 / H_n'(x_i)^2 in the normalized scale.
+	*/
+	const double pi_m4 = 0.75112554446494248286; // pi^(-1/4)
+	int m = (n + 1) / 2;
+	double z = 0, derivative = 0;
+	for (int i = 0; i < m; i++) {
+		if (i == 0)
+			z = sqrt(2. * n + 1) - 1.85575 * pow(2. * n + 1, -0.16667);
+		else if (i == 1)
+			z -= 1.14 * pow(n, 0.426) / z;
+		else if (i == 2)
+			z = 1.86 * z - 0.86 * nodes[0];
+		else if (i == 3)
+			z = 1.91 * z - 0.91 * nodes[1];
+		else
+			z = 2 * z - nodes[i - 2];
+		for (int iteration = 0; iteration < 100; iteration++) {
+			double p1 = pi_m4, p2 = 0;
+			for (int j = 0; j < n; j++) {
+				double p3 = p2;
+				p2 = p1;
+				p1 = z * sqrt(2. / (j + 1)) * p2 - sqrt((double)j / (j + 1)) * p3;
+			}
+			derivative = sqrt(2. * n) * p2;
+			double step = p1 / derivative;
+			z -= step;
+			if (fabs(step) <= 1e-15 * max(1., fabs(z)))
+				break;
+		}
+		nodes[i] = z;
+		nodes[n - 1 - i] = -z;
+		weights[i] = 2 / (derivative * derivative);
+		weights[n - 1 - i] = weights[i];
+	}
+}
+
+void std_normal_pdf(const double* x, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = std_normal_pdf(x[i]);
+}
+
+void std_normal_cum(const double* x, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = std_normal_cum(x[i]);
+}
+
+void std_normal_cum_fast(const double* x, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = std_normal_cum_fast(x[i]);
+}
+
+void std_normal_inv(const double* p, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = std_normal_inv(p[i]);
+}
+
+void std_normal_inv_fast(const double* p, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = std_normal_inv_fast(p[i]);
+}
+
+void exp_fast(const double* x, double* result, int n) {
+	for (int i = 0; i < n; i++)
+		result[i] = exp_fast(x[i]);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+	The Header file of the "Numerics" functions.
+	Special functions shared by every pricer : Standard Normal PDF, CDF, inverse CDF, bivariate CDF, exponential, and Gauss-Hermite quadrature.
+	The accurate versions are close to machine precision. The fast versions trade accuracy for speed :
+	branch-free kernels whose array versions are vectorized by the compiler.
+*/
+
+double std_normal_pdf(double x); // Standard Normal Density function.
+double std_normal_cum(double x); // Standard Normal Cumulative function : West's double precision version of Hart's algorithm (Cody-like rational approximation). Absolute error < 1e-15.
+double std_normal_cum_fast(double x); // Standard Normal Cumulative function : Abramowitz & Stegun 26.2.17. Absolute error < 7.5e-8.
+double std_normal_inv(double p); // Standard Normal inverse Cumulative function : Wichura's AS241 (PPND16). Relative error < 1e-14.
+double std_normal_inv_fast(double p); // Standard Normal inverse Cumulative function : Acklam's rational approximation. Relative error < 1.15e-9.
+double bivariate_normal_cum(double x, double y, double rho); // Bivariate Standard Normal Cumulative function P(X < x, Y < y) with correlation rho : Genz's BVND algorithm. Absolute error < 1e-15, < 5e-15 for |rho| >= 0.925.
+double exp_fast(double x); // Exponential : Cody-Waite range reduction and a polynomial kernel. Relative error < 3e-16, no special values handling.
+void gauss_hermite(int n, double* nodes, double* weights); // Nodes and weights of the n-point Gauss-Hermite quadrature, for the weight exp(-x^2). Nodes in decreasing order, accurate for n <= 150.
+
+// Array versions : result[i] = f(x[i]) for i in [0, n).
+void std_normal_pdf(const double* x, double* result, int n);
+void std_normal_cum(const double* x, double* result, int n);
+void std_normal_cum_fast(const double* x, double* result, int n);
+void std_normal_inv(const double* p, double* result, int n);
+void std_normal_inv_fast(const double* p, double* result, int n);
+void exp_fast(const double* x, double* result, int n);
@@ -2,6 +2,7 @@
 #include <iostream>
 #include "Option.h"
 #include <algorithm>
+#include <cctype>
 
 using namespace std;
 
@@ -23,39 +24,50 @@ VanillaOption::VanillaOption(double strike, double maturity, int flavor) {
 
 	/* The Vanilla Options constructor. */
 
+	type = "Vanilla";
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 }
 
-double VanillaOption::payoff(vector<double> path) {
+template <typename Real> double VanillaOption::evaluate(const Real* path, size_t n) {
 
 	/* The Vanilla Options PayOff. */
 
-	double S_T = path[path.size() - 1]; 
+	double S_T = path[n - 1]; 
 	return phi * (S_T - K) > 0 ? phi * (S_T - K) : 0;
 }
 
+double VanillaOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double VanillaOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
+
 DigitalOption::DigitalOption(double strike, double maturity, int flavor) {
 	
 	/* The Digital Options constructor. */
 
+	type = "Digital";
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 }
 
-double DigitalOption::payoff(vector<double> path) {
+template <typename Real> double DigitalOption::evaluate(const Real* path, size_t n) {
 
 	/* The Digital Options PayOff. */
 
-	double S_T = path[path.size() - 1];
+	double S_T = path[n - 1];
 	return phi * (S_T - K) > 0 ? 1 : 0;
 }
 
-BarrierOption::BarrierOption(double strike, double barrier, double maturity, int flavor, string barrierType) {
+double DigitalOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double DigitalOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
+
+BarrierOption::BarrierOption(double strike, double barrier, double maturity, int flavor, string barrierType, bool monitored) {
 	
-	/* The Barrier Options constructor. */
+	/* 
+		The Barrier Options constructor. 
+		The barrier type is read once here : the PayOff only checks the "up" and "knockIn" flags.
+	*/
 
 	if (flavor == 1 && barrier < strike) {
 		cout << "The barrier level must be greater than the strike to benefit from the Barrier Call Option." << endl;
@@ -65,97 +77,125 @@ BarrierOption::BarrierOption(double strike, double barrier, double maturity, int
 		cout << "The barrier level must be smaller than the strike to benefit from the Barrier Put Option." << endl;
 		exit(-1);
 	}
+
+	// Remove the spaces from the string type and switch it to upper cases
+	barrierType.erase(remove_if(barrierType.begin(), barrierType.end(), ::isspace), barrierType.end());
+	for (char& c : barrierType) c = toupper(c);
+
+	if (barrierType == "UPOUT" && flavor == 1)
+		type = "Up Out";
+	else if (barrierType == "UPIN" && flavor == 1)
+		type = "Up In";
+	else if (barrierType == "DOWNOUT" && flavor == -1)
+		type = "Down Out";
+	else if (barrierType == "DOWNIN" && flavor == -1)
+		type = "Down In";
+	else {
+		cout << "Unknow Barrier Option Type. The possible types are : \"Up Out\" and \"Up In\" for Calls, and \"Down Out\" and \"Down In\" for Puts." << endl;
+		exit(-1);
+	}
 	
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 	setBarrier(barrier);
-	type = barrierType;
+	up = flavor == 1;
+	knockIn = barrierType == "UPIN" || barrierType == "DOWNIN";
+	pathDependent = monitored;
 }
 
-double BarrierOption::payoff(vector<double> path) {
-
-	/* The Barrier Options PayOff. */
+template <typename Real> double BarrierOption::evaluate(const Real* path, size_t n) {
 
-	double S_T = path[path.size() - 1];
-
-	// Remove the spaces from the string type and switch it to upper cases
-	type.erase(remove_if(type.begin(), type.end(), isspace), type.end());
-	for (char& c : type) c = toupper(c);
+	/* 
+		The Barrier Options PayOff. 
+		European Barriers only look at S_T, monitored Barriers look at every date of the simulated path. The Monte-Carlo engines price the
+		monitored Barriers continuously instead : they weight the Vanilla payoff by the Brownian bridge survival between the dates.
+	*/
 
-	if (type == "UPOUT" && phi == 1) {
-		return ((S_T - K) > 0) && ((B - S_T) > 0) ? (S_T - K) : 0;
-	}
-	else if (type == "UPIN" && phi == 1) {
-		return (S_T - B) > 0 ? (S_T - K) : 0;
-	}
-	else if (type == "DOWNOUT" && phi == -1) {
-		return ((K - S_T) > 0) && ((S_T - B) > 0) ? (K - S_T) : 0;
-	}
-	else if (type == "DOWNIN" && phi == -1) {
-		return (B - S_T) > 0 ? (K - S_T) : 0;
-	}
-	else {
-		cout << "Unknow Barrier Option Type. The possible types are : \"Up Out\" and \"Up In\" for Calls, and \"Down Out\" and \"Down In\" for Puts." << endl;
-		exit(-1);
+	double S_T = path[n - 1];
+	double S_max = S_T;
+	double S_min = S_T;
+	if (pathDependent) {
+		S_max = *max_element(path, path + n);
+		S_min = *min_element(path, path + n);
 	}
 
+	double vanilla = phi * (S_T - K) > 0 ? phi * (S_T - K) : 0;
+	bool hit = up ? (S_max - B) > 0 : (B - S_min) > 0;
+	return hit == knockIn ? vanilla : 0;
 }
 
+double BarrierOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double BarrierOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
+
 AsianOption::AsianOption(double strike, double maturity, int flavor, double frequency) {
 	
 	/* The Asian Options constructor. */
 
+	type = "Asian";
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 	setFreq(frequency);
+	pathDependent = true;
+	asian = true;
 }
 
-double AsianOption::payoff(vector<double> path) {
+template <typename Real> double AsianOption::evaluate(const Real* path, size_t n) {
 	
 	/* The argument "path" contains the underlying fixings to be included in the average computation. */
 
 	double avg_S = 0; 
-	for (double s : path)
-		avg_S += s / path.size();
+	for (size_t i = 0; i < n; i++)
+		avg_S += path[i] / (double)n;
 	return phi * (avg_S - K) > 0 ? phi * (avg_S - K) : 0;
 }
 
+double AsianOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double AsianOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
+
 BasketOption::BasketOption(double strike, double maturity, int flavor, double d) {
 	
 	/* The Basket Options constructor. */
 
+	type = "Basket";
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 	setSize(d);
 }
 
-double BasketOption::payoff(vector<double> path) {
+template <typename Real> double BasketOption::evaluate(const Real* path, size_t n) {
 	
 	/* The argument "path" contains the underlyings spot prices at maturity. */
 
 	double basket = 0;
-	for (double s : path)
-		basket += s / path.size();
+	for (size_t i = 0; i < n; i++)
+		basket += path[i] / (double)n;
 	return phi * (basket - K) > 0 ? phi * (basket - K) : 0;
 }
 
+double BasketOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double BasketOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
+
 SpreadOption::SpreadOption(double strike, double maturity, int flavor) {
 	
 	/* The Spread Options constructor. Size defaulted to 2. */
 
+	type = "Spread";
 	setStrike(strike);
 	setMaturity(maturity);
 	setPhi(flavor);
 	setSize(2);
 }
 
-double SpreadOption::payoff(vector<double> path) {
+template <typename Real> double SpreadOption::evaluate(const Real* path, size_t n) {
 	
 	/* The argument "path" contains the two underlyings spot prices at maturity. */
 
-	double spread = path[0] - path[1];
+	double spread = (double)path[0] - path[1];
 	return phi * (spread - K) > 0 ? phi * (spread - K) : 0;
 }
+
+double SpreadOption::payoff(const vector<double>& path) { return evaluate(path.data(), path.size()); }
+double SpreadOption::payoff(const float* path, size_t n) { return evaluate(path, n); }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <new>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
 
 using namespace std;
 
@@ -10,15 +14,16 @@ using namespace std;
 */
 
 class Option {
-private :
-	string type;
 protected :
+	const char* type = ""; // The flavor name : a string literal, so that the Options stay trivially destructible.
 	double K; // The Strike.
 	double T; // The Maturity date.
 	int phi; // Phi is equal to +1 for Call Options, and -1 for Put Options.
 	double freq = 1; // The frequency is necessary to define Asian Options. It is defaulted to 1 for the other flavors.
 	double size = 1; // The size is necessary to define Multi-Asset Options. It is defaulted to 1 for the other flavors.
 	double B; // The barrier level is necessary to define Barrier Options.
+	bool pathDependent = false; // True for Options whose payoff needs the whole simulated path : Arithmetic Asians and monitored Barriers.
+	bool asian = false; // True for the Arithmetic Asians, whose simulated path only holds the fixings.
 public:
 	void setMaturity(double maturity) { T = maturity; };
 	double getMaturity() { return T; };
@@ -32,60 +37,106 @@ public:
 	double getFreq() { return freq; };
 	void setBarrier(double barrier) { B = barrier; };
 	double getBarrier() { return B; };
-	virtual string getType() { return type; };
-	virtual double payoff(vector<double> path) = 0; // The PayOff script is a pure virtual method.
+	bool isPathDependent() { return pathDependent; };
+	bool isAsian() { return asian; }; // Flavor test of the simulation loops, cheaper than comparing "getType()".
+	string getType() { return type; };
+	virtual double payoff(const vector<double>& path) = 0; // The PayOff script is a pure virtual method.
+	virtual double payoff(const float* path, size_t n) = 0; // The PayOff of a single precision path of n dates, read in place.
 };
 
-class VanillaOption : public Option {
+class VanillaOption final : public Option {
 private :
-	string type = "Vanilla";
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public :
 	VanillaOption(double strike, double maturity, int flavor);
-	string getType() { return type; };
-	double payoff(vector<double> path);
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
 };
 
-class DigitalOption : public Option {
-private:
-	string type = "Digital";
+class DigitalOption final : public Option {
+private :
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public:
 	DigitalOption(double strike, double maturity, int flavor);
-	string getType() { return type; };
-	double payoff(vector<double> path);
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
 };
 
-class BarrierOption : public Option {
+class BarrierOption final : public Option {
 private:
-	string type = "Digital";
+	bool up; // True for the "Up" barriers, false for the "Down" barriers.
+	bool knockIn; // True for the "In" barriers, false for the "Out" barriers.
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public:
-	BarrierOption(double strike, double barrier, double maturity, int flavor, string barrierType);
-	string getType() { return type; };
-	double payoff(vector<double> path);
+	BarrierOption(double strike, double barrier, double maturity, int flavor, string barrierType, bool monitored = false); // "monitored" : the barrier is monitored continuously up to the maturity, instead of at maturity only.
+	bool isUp() { return up; };
+	bool isKnockIn() { return knockIn; };
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
 };
 
-class AsianOption : public Option {
-private:
-	string type = "Asian";
+class AsianOption final : public Option {
+private :
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public:
 	AsianOption(double strike, double maturity, int flavor, double freq);
-	string getType() { return type; };
-	double payoff(vector<double> path);
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
 };
 
-class BasketOption : public Option {
-private:
-	string type = "Basket";
+class BasketOption final : public Option {
+private :
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public:
 	BasketOption(double strike, double maturity, int flavor, double d);
-	string getType() { return type; };
-	double payoff(vector<double> path);
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
 };
 
-class SpreadOption : public Option {
-private:
-	string type = "Spread";
+class SpreadOption final : public Option {
+private :
+	template <typename Real> double evaluate(const Real* path, size_t n); // The PayOff of both precisions.
 public:
 	SpreadOption(double strike, double maturity, int flavor);
-	string getType() { return type; };
-	double payoff(vector<double> path);
-};
\ No newline at end of file
+	double payoff(const vector<double>& path);
+	double payoff(const float* path, size_t n);
+};
+
+class OptionValue {
+	/*
+		Value type holding any Option flavor inline : a book of Options is a single contiguous vector<OptionValue>, built and freed with one allocation.
+		The Options are trivially destructible, so destroying an "OptionValue" costs nothing.
+	*/
+private :
+	static constexpr size_t capacity = max({ sizeof(VanillaOption), sizeof(DigitalOption), sizeof(BarrierOption), sizeof(AsianOption), sizeof(BasketOption), sizeof(SpreadOption) });
+	alignas(alignof(max_align_t)) unsigned char storage[capacity];
+	void (*copy)(const void* from, void* to) = nullptr; // Copy constructor of the held flavor, null when empty.
+	ptrdiff_t offset = 0; // Position of the "Option" base in the held flavor.
+public :
+	OptionValue() {};
+	OptionValue(const OptionValue& other) : copy(other.copy), offset(other.offset) { if (copy) copy(other.storage, storage); };
+	OptionValue& operator=(const OptionValue& other) {
+		copy = other.copy;
+		offset = other.offset;
+		if (copy && this != &other)
+			copy(other.storage, storage);
+		return *this;
+	};
+	template <typename T, typename... Args> T* emplace(Args&&... args) {
+		static_assert(is_base_of<Option, T>::value && sizeof(T) <= capacity && is_trivially_destructible<T>::value, "OptionValue holds the trivially destructible Option flavors.");
+		T* option = new (storage) T(std::forward<Args>(args)...);
+		offset = (unsigned char*)static_cast<Option*>(option) - storage;
+		copy = [](const void* from, void* to) { new (to) T(*(const T*)from); };
+		return option;
+	}; // Replaces the held Option by a "T" built in place, e.g. book.emplace_back().emplace<VanillaOption>(105, 1, 1).
+	template <typename T, typename... Args> static OptionValue make(Args&&... args) {
+		OptionValue value;
+		value.emplace<T>(std::forward<Args>(args)...);
+		return value;
+	};
+	bool empty() const { return copy == nullptr; };
+	Option* get() { return copy ? std::launder((Option*)(storage + offset)) : nullptr; };
+	Option* operator->() { return get(); };
+};
+
+static_assert(is_trivially_destructible<VanillaOption>::value && is_trivially_destructible<BarrierOption>::value, "The Options are trivially destructible contract records.");
@@ -0,0 +1,307 @@
+#include "Revaluation.h"
+#include <cstring>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+/*
+	The Source file of the incremental "Revaluation" of a book.
+*/
+
+bool MarketObject::operator==(const MarketObject& other) const {
+	for (int i = 0; i < TRADE_MAX_ASSETS; i++)
+		if (spot[i] != other.spot[i] || vol[i] != other.vol[i])
+			return false;
+	return model == other.model && rate == other.rate && corr == other.corr && v0 == other.v0 && kappa == other.kappa
+		&& theta == other.theta && xi == other.xi && rho == other.rho;
+}
+
+static void apply_market(const MarketObject& market, TradeRecord& trade) {
+
+	/* Copies the market object in the model fields of the trade. */
+
+	trade.model = market.model;
+	trade.rate = market.rate;
+	memcpy(trade.spot, market.spot, sizeof(trade.spot));
+	memcpy(trade.vol, market.vol, sizeof(trade.vol));
+	trade.corr = market.corr;
+	trade.v0 = market.v0;
+	trade.kappa = market.kappa;
+	trade.theta = market.theta;
+	trade.xi = market.xi;
+	trade.rho = market.rho;
+}
+
+ValuationCache::ValuationCache(size_t capacity, int nb_shards) : shards(max(1, nb_shards)) {
+
+	/* Valuation cache constructor : the capacity is shared equally by the shards. */
+
+	shardCapacity = max((size_t)1, capacity / shards.size());
+}
+
+uint64_t ValuationCache::hash(const TradeRecord& key) {
+
+	/* FNV-1a hash of the bytes of the record, after its id : "TradeRecord" has no padding, so equal inputs have equal bytes. */
+
+	const unsigned char* bytes = (const unsigned char*)&key;
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = sizeof(key.id); i < sizeof(TradeRecord); i++) {
+		h ^= bytes[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static bool same_inputs(const TradeRecord& a, const TradeRecord& b) {
+	return memcmp((const char*)&a + sizeof(a.id), (const char*)&b + sizeof(b.id), sizeof(TradeRecord) - sizeof(a.id)) == 0;
+}
+
+bool ValuationCache::find(const TradeRecord& key, uint64_t key_hash, Valuation& value) {
+	Shard& shard = shards[key_hash % shards.size()];
+	lock_guard<mutex> lock(shard.m);
+	auto it = shard.index.find(key_hash);
+	if (it == shard.index.end() || !same_inputs(it->second->key, key)) {
+		misses.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+	shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+	value = it->second->value;
+	hits.fetch_add(1, memory_order_relaxed);
+	return true;
+}
+
+void ValuationCache::insert(const TradeRecord& key, uint64_t key_hash, const Valuation& value) {
+
+	/* A hash collision replaces the previous key : the cache keeps a single valuation per hash. */
+
+	Shard& shard = shards[key_hash % shards.size()];
+	lock_guard<mutex> lock(shard.m);
+	auto it = shard.index.find(key_hash);
+	if (it != shard.index.end()) {
+		it->second->key = key;
+		it->second->value = value;
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+		return;
+	}
+	if (shard.index.size() >= shardCapacity) {
+		shard.index.erase(shard.lru.back().hash);
+		shard.lru.pop_back();
+		evictions.fetch_add(1, memory_order_relaxed);
+	}
+	shard.lru.push_front({ key, key_hash, value });
+	shard.index[key_hash] = shard.lru.begin();
+}
+
+void ValuationCache::clear() {
+	for (Shard& shard : shards) {
+		lock_guard<mutex> lock(shard.m);
+		shard.index.clear();
+		shard.lru.clear();
+	}
+}
+
+CacheStats ValuationCache::getStats() {
+	CacheStats stats;
+	stats.hits = hits.load(memory_order_relaxed);
+	stats.misses = misses.load(memory_order_relaxed);
+	stats.evictions = evictions.load(memory_order_relaxed);
+	for (Shard& shard : shards) {
+		lock_guard<mutex> lock(shard.m);
+		stats.size += shard.index.size();
+	}
+	return stats;
+}
+
+TradeStatus valueTrade(const TradeRecord& trade, MonteCarlo& mc, Valuation& value) {
+	/*
+		Price and Greeks of the trade. The Greeks are central finite differences of the analytical prices :
+		delta and gamma for a parallel move of the spots of 0.1% of the smallest spot, vega for a parallel move of the volatilities
+		(of sqrt(v0) for the Heston trades) of 1bp, and rho for a move of the rate of 1bp.
+		The Monte-Carlo prices are too noisy to be bumped : their Greeks are left to 0.
+	*/
+	value = Valuation();
+	value.status = priceTrade(trade, mc, value.price);
+	if (value.status != TRADE_OK || trade.method != METHOD_ANALYTICAL)
+		return (TradeStatus)value.status;
+
+	int d = (int)trade.size;
+	auto price_of = [&mc](const TradeRecord& bumped) {
+		double p = 0;
+		priceTrade(bumped, mc, p);
+		return p;
+	};
+
+	// Delta & Gamma
+	double h = 1e-3 * *min_element(trade.spot, trade.spot + d);
+	TradeRecord up = trade, down = trade;
+	for (int i = 0; i < d; i++) {
+		up.spot[i] += h;
+		down.spot[i] -= h;
+	}
+	double price_up = price_of(up);
+	double price_down = price_of(down);
+	value.delta = (price_up - price_down) / (2 * h);
+	value.gamma = (price_up - 2 * value.price + price_down) / (h * h);
+
+	// Vega : the down move is reduced for the volatilities close to 0
+	up = trade;
+	down = trade;
+	double h_up = 1e-4, h_down = 1e-4;
+	if (trade.model == MODEL_HESTON) {
+		double vol0 = sqrt(trade.v0);
+		h_down = min(h_down, vol0);
+		up.v0 = pow(vol0 + h_up, 2);
+		down.v0 = pow(vol0 - h_down, 2);
+	}
+	else {
+		h_down = min(h_down, 0.5 * *min_element(trade.vol, trade.vol + d));
+		for (int i = 0; i < d; i++) {
+			up.vol[i] += h_up;
+			down.vol[i] -= h_down;
+		}
+	}
+	value.vega = (price_of(up) - price_of(down)) / (h_up + h_down);
+
+	// Rho
+	up = trade;
+	down = trade;
+	up.rate += 1e-4;
+	down.rate -= 1e-4;
+	value.rho = (price_of(up) - price_of(down)) / 2e-4;
+	return TRADE_OK;
+}
+
+Revaluation::Revaluation(size_t cache_capacity) : cache(cache_capacity) {}
+
+void Revaluation::markDirty(TradeEntry& entry, uint64_t id) {
+	entry.hash = ValuationCache::hash(entry.inputs);
+	if (!entry.dirty) {
+		entry.dirty = true;
+		dirtyTrades.push_back(id);
+	}
+}
+
+void Revaluation::setMarket(const string& name, const MarketObject& market) {
+
+	/* Only the trades of the market object are updated, and only when the market object really changes. */
+
+	unique_lock<shared_mutex> lock(m);
+	auto it = markets.find(name);
+	if (it != markets.end() && it->second == market)
+		return;
+	markets[name] = market;
+	for (uint64_t id : dependents[name]) {
+		TradeEntry& entry = trades.at(id);
+		apply_market(market, entry.inputs);
+		markDirty(entry, id);
+	}
+}
+
+bool Revaluation::addTrade(const TradeRecord& trade, const string& market) {
+	unique_lock<shared_mutex> lock(m);
+	auto market_it = markets.find(market);
+	if (market_it == markets.end())
+		return false;
+
+	auto it = trades.find(trade.id);
+	if (it != trades.end()) {
+		vector<uint64_t>& previous = dependents[it->second.market];
+		previous.erase(find(previous.begin(), previous.end(), trade.id));
+	}
+	else
+		it = trades.emplace(trade.id, TradeEntry{ trade, 0, market, false }).first;
+
+	TradeEntry& entry = it->second;
+	entry.inputs = trade;
+	entry.market = market;
+	apply_market(market_it->second, entry.inputs);
+	markDirty(entry, trade.id);
+	dependents[market].push_back(trade.id);
+	return true;
+}
+
+void Revaluation::removeTrade(uint64_t id) {
+
+	/* The removed trade may stay in the dirty list : "revalue" skips the unknown trades. */
+
+	unique_lock<shared_mutex> lock(m);
+	auto it = trades.find(id);
+	if (it == trades.end())
+		return;
+	vector<uint64_t>& market_trades = dependents[it->second.market];
+	market_trades.erase(find(market_trades.begin(), market_trades.end(), id));
+	trades.erase(it);
+}
+
+Valuation Revaluation::compute(const TradeRecord& inputs, uint64_t hash) {
+
+	/* Valuation of the inputs : from the cache, or computed and cached. */
+
+	Valuation value;
+	if (cache.find(inputs, hash, value))
+		return value;
+	static thread_local MonteCarlo mc;
+	valueTrade(inputs, mc, value);
+	cache.insert(inputs, hash, value);
+	return value;
+}
+
+size_t Revaluation::revalue(int nb_threads) {
+	/*
+		The dirty trades are taken under the lock, then valued without it by "nb_threads" threads : the lookups of the book and the market
+		updates go on during the revaluation. A trade updated meanwhile becomes dirty again, for the next revaluation.
+	*/
+	vector<pair<TradeRecord, uint64_t>> work;
+	{
+		unique_lock<shared_mutex> lock(m);
+		work.reserve(dirtyTrades.size());
+		for (uint64_t id : dirtyTrades) {
+			auto it = trades.find(id);
+			if (it != trades.end() && it->second.dirty) {
+				work.emplace_back(it->second.inputs, it->second.hash);
+				it->second.dirty = false;
+			}
+		}
+		dirtyTrades.clear();
+	}
+
+	atomic<size_t> next(0);
+	auto value_trades = [&] {
+		for (size_t i = next++; i < work.size(); i = next++)
+			compute(work[i].first, work[i].second);
+	};
+	vector<thread> workers;
+	for (int t = 1; t < nb_threads; t++)
+		workers.emplace_back(value_trades);
+	value_trades();
+	for (thread& worker : workers)
+		worker.join();
+	return work.size();
+}
+
+bool Revaluation::getValuation(uint64_t id, Valuation& value) {
+	TradeRecord inputs;
+	uint64_t hash;
+	{
+		shared_lock<shared_mutex> lock(m);
+		auto it = trades.find(id);
+		if (it == trades.end())
+			return false;
+		inputs = it->second.inputs;
+		hash = it->second.hash;
+	}
+	value = compute(inputs, hash);
+	return true;
+}
+
+size_t Revaluation::getNbTrades() const {
+	shared_lock<shared_mutex> lock(m);
+	return trades.size();
+}
+
+size_t Revaluation::getNbDirty() const {
+	shared_lock<shared_mutex> lock(m);
+	return dirtyTrades.size();
+}
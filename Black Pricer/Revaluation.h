@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include "Trade.h"
+
+using namespace std;
+
+/*
+	The Header file of the incremental "Revaluation" of a book.
+	The trades reference named market objects (rate, spots, volatilities, correlation and Heston parameters). Updating a market object marks its
+	dependent trades dirty, and "revalue" only recomputes the dirty trades. The valuations (price and Greeks) are kept in a "ValuationCache" keyed
+	on all the inputs of the trade, so a trade whose inputs come back to a known state, or which shares its inputs with another trade, is not
+	recomputed either. The cache memory is bounded : the least recently used valuations are evicted, and recomputed when they are needed again.
+*/
+
+struct Valuation {
+	int32_t status = TRADE_OK;
+	double price = 0;
+	double delta = 0; // Sensitivity to a parallel move of the spots.
+	double gamma = 0;
+	double vega = 0; // Sensitivity to a parallel move of the volatilities (of sqrt(v0) for the Heston trades).
+	double rho = 0; // Sensitivity to the rate.
+};
+
+struct MarketObject {
+	int32_t model = MODEL_BLACK;
+	double rate = 0;
+	double spot[TRADE_MAX_ASSETS] = {};
+	double vol[TRADE_MAX_ASSETS] = {};
+	double corr = 0;
+	double v0 = 0, kappa = 0, theta = 0, xi = 0, rho = 0; // Heston parameters.
+	bool operator==(const MarketObject& other) const;
+};
+
+struct CacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	uint64_t size = 0; // Number of cached valuations.
+};
+
+class ValuationCache {
+	/*
+		LRU cache of the valuations, keyed on the trade inputs (the "TradeRecord" without its id). The entries are spread over shards with
+		their own lock and LRU list, so concurrent lookups of different keys rarely wait for each other.
+	*/
+private :
+	struct Entry {
+		TradeRecord key;
+		uint64_t hash;
+		Valuation value;
+	};
+	struct Shard {
+		mutex m;
+		list<Entry> lru; // Most recently used first.
+		unordered_map<uint64_t, list<Entry>::iterator> index;
+	};
+	vector<Shard> shards;
+	size_t shardCapacity;
+	atomic<uint64_t> hits{ 0 };
+	atomic<uint64_t> misses{ 0 };
+	atomic<uint64_t> evictions{ 0 };
+public :
+	ValuationCache(size_t capacity, int nb_shards = 16);
+	static uint64_t hash(const TradeRecord& key); // Hash of the inputs : the id is ignored.
+	bool find(const TradeRecord& key, uint64_t key_hash, Valuation& value); // Copies the cached valuation, and marks it as recently used.
+	void insert(const TradeRecord& key, uint64_t key_hash, const Valuation& value); // Inserts or replaces the valuation, and evicts the least recently used one of the shard when it is full.
+	void clear();
+	CacheStats getStats();
+};
+
+TradeStatus valueTrade(const TradeRecord& trade, MonteCarlo& mc, Valuation& value); // Price and bump-and-revalue Greeks of the analytical methods (the Monte-Carlo methods only get their price).
+
+class Revaluation {
+private :
+	struct TradeEntry {
+		TradeRecord inputs; // Contract terms, with the fields of its market object.
+		uint64_t hash; // Hash of the inputs.
+		string market;
+		bool dirty;
+	};
+	ValuationCache cache;
+	unordered_map<uint64_t, TradeEntry> trades;
+	unordered_map<string, MarketObject> markets;
+	unordered_map<string, vector<uint64_t>> dependents; // Trades of each market object.
+	vector<uint64_t> dirtyTrades;
+	mutable shared_mutex m; // Guards the trades, the market objects and the dependencies. The cache has its own locks.
+	void markDirty(TradeEntry& entry, uint64_t id);
+	Valuation compute(const TradeRecord& inputs, uint64_t hash);
+public :
+	Revaluation(size_t cache_capacity = 1 << 20);
+	void setMarket(const string& name, const MarketObject& market); // Creates or updates the market object. Its trades become dirty when it changes.
+	bool addTrade(const TradeRecord& trade, const string& market); // Adds (or replaces) the trade "trade.id" on the market object, returns false if the market object is unknown.
+	void removeTrade(uint64_t id);
+	size_t revalue(int nb_threads = 1); // Recomputes the dirty trades that are not cached, returns the number of dirty trades.
+	bool getValuation(uint64_t id, Valuation& value); // Valuation of the trade, recomputed if it is dirty or evicted. Returns false for an unknown trade.
+	size_t getNbTrades() const;
+	size_t getNbDirty() const;
+	CacheStats getCacheStats() { return cache.getStats(); };
+};
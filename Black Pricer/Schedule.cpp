@@ -0,0 +1,109 @@
+#include "Schedule.h"
+#include "Instrumentation.h"
+#include <cmath>
+#include <map>
+#include <list>
+#include <tuple>
+#include <mutex>
+
+using namespace std;
+
+/*
+	The Source file of the class "Schedule".
+*/
+
+const double SCHEDULE_CACHE_STEPS = 1 << 20; // Time steps kept by the Schedules cache, in total : about 17 MB.
+const double SCHEDULE_ENTRY_STEPS = 16; // Charge of every cached Schedule for its object, vector headers and cache nodes, in time steps : about 270 bytes.
+
+Schedule::Schedule(double maturity, double nb_steps, double frequency) {
+	/*
+		Schedule constructor.
+		The step dates s * T / nbSteps and the fixing dates f * T / freq are merged as fractions of the maturity :
+		s / nbSteps and f / freq are compared with integer arithmetic, so that the common dates are merged and the fixings are found exactly.
+	*/
+	T = maturity;
+	nbSteps = nb_steps;
+	freq = frequency;
+
+	long long n = (long long)nbSteps;
+	long long m = (long long)freq;
+	long long s = 1;
+	long long f = 1;
+	double prev_t = 0;
+	dt.reserve(n + m);
+	sqrt_dt.reserve(n + m);
+	fixings.reserve(n + m);
+
+	while (s <= n || f <= m) {
+		double t;
+		bool fixing;
+		if (f > m || (s <= n && s * m < f * n)) {
+			// Step date only
+			t = s * T / n;
+			fixing = false;
+			s++;
+		}
+		else {
+			// Fixing date, possibly shared with a step date
+			if (s <= n && s * m == f * n)
+				s++;
+			t = f * T / m;
+			fixing = true;
+			f++;
+		}
+		dt.push_back(t - prev_t);
+		sqrt_dt.push_back(sqrt(t - prev_t));
+		fixings.push_back(fixing);
+		prev_t = t;
+	}
+}
+
+shared_ptr<const Schedule> Schedule::get(double maturity, double nb_steps, double frequency) {
+	/*
+		"get" method returns the cached Schedule of (maturity, nb_steps, frequency), and builds it on the first call.
+		The cache is a LRU bounded to SCHEDULE_CACHE_STEPS time steps : a batch with a new maturity on every trade keeps a flat memory.
+		Every entry is charged SCHEDULE_ENTRY_STEPS on top of its steps, so that the one-step grids of the Vanillas are cached too without an unbounded count.
+		The grids larger than a quarter of the cache would evict most of it : they are built for the caller only.
+		The callers look up one Schedule per price, so a plain mutex is enough.
+	*/
+	typedef tuple<double, double, double> Key;
+	static list<pair<Key, shared_ptr<const Schedule>>> lru; // Most recently used first.
+	static map<Key, list<pair<Key, shared_ptr<const Schedule>>>::iterator> index;
+	static double cached_steps = 0;
+	static mutex cache_mutex;
+
+	double max_steps = nb_steps + frequency; // Upper bound of the merged grid size.
+	if (max_steps > SCHEDULE_CACHE_STEPS / 4) {
+		PRICER_COUNT_ALLOCATIONS(4); // The Schedule and its three vectors.
+		return make_shared<const Schedule>(maturity, nb_steps, frequency);
+	}
+
+	Key key(maturity, nb_steps, frequency);
+	{
+		lock_guard<mutex> lock(cache_mutex);
+		auto it = index.find(key);
+		if (it != index.end()) {
+			lru.splice(lru.begin(), lru, it->second);
+			return it->second->second;
+		}
+	}
+
+	// Built outside the lock : when two threads build the same grid, the first one inserted is kept
+	shared_ptr<const Schedule> schedule = make_shared<const Schedule>(maturity, nb_steps, frequency);
+	PRICER_COUNT_ALLOCATIONS(4);
+	lock_guard<mutex> lock(cache_mutex);
+	auto it = index.find(key);
+	if (it != index.end())
+		return it->second->second;
+	double charge = schedule->size() + SCHEDULE_ENTRY_STEPS;
+	while (!lru.empty() && cached_steps + charge > SCHEDULE_CACHE_STEPS) {
+		cached_steps -= lru.back().second->size() + SCHEDULE_ENTRY_STEPS;
+		index.erase(lru.back().first);
+		lru.pop_back();
+	}
+	lru.emplace_front(key, schedule);
+	index[key] = lru.begin();
+	PRICER_COUNT_ALLOCATIONS(2); // The list and map nodes.
+	cached_steps += charge;
+	return schedule;
+}
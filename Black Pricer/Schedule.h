@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+/*
+	The Header file of the class "Schedule".
+	The "Schedule" is the immutable time grid used for path simulations : the union of "nbSteps" equal steps and of the "freq" fixing dates up to the maturity.
+	It precomputes the time steps, their square roots, and the fixing dates bitmap. Schedules are built once and shared through a thread-safe, size-bounded cache.
+*/
+
+class Schedule {
+private :
+	double T; // The Maturity date.
+	double nbSteps; // Number of equal Time steps.
+	double freq; // Number of fixing dates, equally spaced up to the maturity.
+	vector<double> dt; // The time steps.
+	vector<double> sqrt_dt; // The square roots of the time steps.
+	vector<bool> fixings; // Fixing dates bitmap : fixings[i] is true if the date at the end of the step i is a fixing date.
+public :
+	Schedule(double maturity, double nb_steps, double frequency);
+	double getMaturity() const { return T; };
+	double getNbSteps() const { return nbSteps; };
+	double getFreq() const { return freq; };
+	int size() const { return (int)dt.size(); }; // Number of time steps of the grid.
+	double getDt(int i) const { return dt[i]; };
+	double getSqrtDt(int i) const { return sqrt_dt[i]; };
+	bool isFixing(int i) const { return fixings[i]; };
+	static shared_ptr<const Schedule> get(double maturity, double nb_steps, double frequency); // Returns the cached Schedule, and builds it on the first call. The least recently used Schedules are evicted.
+};
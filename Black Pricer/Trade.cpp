@@ -0,0 +1,331 @@
+#include "Trade.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <vector>
+#include "Option.h"
+#include "BlackScholesModel.h"
+#include "MultiAssetBSModel.h"
+#include "HestonModel.h"
+
+using namespace std;
+
+/*
+	The Source file of the "Trade" records of the batch pricer.
+*/
+
+const char* TRADE_CSV_HEADER = "id,option,flavor,strike,maturity,barrier,barrier_type,monitored,freq,size,model,method,rate,spot,vol,corr,v0,kappa,theta,xi,rho,paths,steps,rmse";
+const char* RESULT_CSV_HEADER = "id,price,status";
+
+const char* STATUS_NAMES[TRADE_STATUS_COUNT] = { "ok", "parse_error", "invalid_contract", "invalid_model", "unsupported" };
+const char* OPTION_NAMES[OPTION_COUNT] = { "VANILLA", "DIGITAL", "BARRIER", "ASIAN", "BASKET", "SPREAD" };
+const char* BARRIER_NAMES[BARRIER_COUNT] = { "Up Out", "Up In", "Down Out", "Down In" };
+
+const char* tradeStatusName(int32_t status) {
+	return status >= 0 && status < TRADE_STATUS_COUNT ? STATUS_NAMES[status] : "unknown";
+}
+
+struct Field {
+	const char* begin;
+	const char* end;
+	bool empty() const { return begin == end; };
+};
+
+static Field trim(const char* begin, const char* end) {
+	while (begin < end && isspace((unsigned char)*begin))
+		begin++;
+	while (end > begin && isspace((unsigned char)end[-1]))
+		end--;
+	return { begin, end };
+}
+
+static bool sameName(Field field, const char* name) {
+
+	/* Case and spaces insensitive comparison, as the Barrier types of the "Option" class. */
+
+	for (const char* c = field.begin; c < field.end; c++) {
+		if (isspace((unsigned char)*c))
+			continue;
+		if (toupper((unsigned char)*c) != *name)
+			return false;
+		name++;
+	}
+	return *name == '\0';
+}
+
+static bool parseNumber(Field field, double& value) {
+
+	/* Empty fields keep the default value of the record. */
+
+	if (field.empty())
+		return true;
+	char* end;
+	value = strtod(field.begin, &end);
+	return end == field.end;
+}
+
+static bool parseList(Field field, double* values, int max_size) {
+
+	/* ";" separated list of up to "max_size" numbers. A single number is used for every underlying. */
+
+	if (field.empty())
+		return true;
+	int n = 0;
+	const char* begin = field.begin;
+	while (true) {
+		const char* end = begin;
+		while (end < field.end && *end != ';')
+			end++;
+		if (n == max_size || !parseNumber(trim(begin, end), values[n]))
+			return false;
+		n++;
+		if (end == field.end)
+			break;
+		begin = end + 1;
+	}
+	for (int i = n; n == 1 && i < max_size; i++)
+		values[i] = values[0];
+	return true;
+}
+
+static bool parseCode(Field field, const char* const* names, int count, int32_t& code) {
+	for (int i = 0; i < count; i++) {
+		if (sameName(field, names[i])) {
+			code = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool isTradeCSVComment(const char* line, const char* end) {
+	Field field = trim(line, end);
+	if (field.empty() || *field.begin == '#')
+		return true;
+	const char* comma = field.begin;
+	while (comma < field.end && *comma != ',')
+		comma++;
+	return sameName(trim(field.begin, comma), "ID");
+}
+
+TradeStatus parseTradeCSV(const char* line, const char* end, TradeRecord& trade) {
+	/*
+		Parses a line with the columns of TRADE_CSV_HEADER. The trailing columns may be omitted, and empty fields keep their defaults.
+		"option" : Vanilla, Digital, Barrier, Asian, Basket or Spread. "flavor" : Call, Put, 1 or -1. "barrier_type" : Up Out, Up In, Down Out or Down In.
+		"model" : Black or Heston. "method" : Analytical, MonteCarlo (or MC) or MLMC. "spot" and "vol" : ";" separated lists for the multi-asset Options.
+	*/
+	static const char* model_names[MODEL_COUNT] = { "BLACK", "HESTON" };
+	static const char* method_names[METHOD_COUNT] = { "ANALYTICAL", "MONTECARLO", "MLMC" };
+	static const char* barrier_names[BARRIER_COUNT] = { "UPOUT", "UPIN", "DOWNOUT", "DOWNIN" };
+
+	trade = TradeRecord();
+	const int nb_columns = 24;
+	Field fields[nb_columns];
+	int n = 0;
+	const char* begin = line;
+	while (true) {
+		const char* comma = begin;
+		while (comma < end && *comma != ',')
+			comma++;
+		if (n == nb_columns)
+			return TRADE_PARSE_ERROR;
+		fields[n++] = trim(begin, comma);
+		if (comma == end)
+			break;
+		begin = comma + 1;
+	}
+	if (n < 5)
+		return TRADE_PARSE_ERROR;
+	for (int i = n; i < nb_columns; i++)
+		fields[i] = Field{ end, end };
+
+	char* id_end;
+	trade.id = strtoull(fields[0].begin, &id_end, 10);
+	bool ok = !fields[0].empty() && id_end == fields[0].end && isdigit((unsigned char)*fields[0].begin);
+	ok = ok && parseCode(fields[1], OPTION_NAMES, OPTION_COUNT, trade.option);
+	if (sameName(fields[2], "CALL"))
+		trade.phi = 1;
+	else if (sameName(fields[2], "PUT"))
+		trade.phi = -1;
+	else {
+		double phi = 0;
+		ok = ok && !fields[2].empty() && parseNumber(fields[2], phi);
+		trade.phi = (int32_t)phi;
+	}
+	double monitored = 0;
+	ok = ok && parseNumber(fields[3], trade.strike) && parseNumber(fields[4], trade.maturity) && parseNumber(fields[5], trade.barrier);
+	ok = ok && (fields[6].empty() || parseCode(fields[6], barrier_names, BARRIER_COUNT, trade.barrier_type));
+	ok = ok && parseNumber(fields[7], monitored) && parseNumber(fields[8], trade.freq) && parseNumber(fields[9], trade.size);
+	ok = ok && (fields[10].empty() || parseCode(fields[10], model_names, MODEL_COUNT, trade.model));
+	if (sameName(fields[11], "MC"))
+		trade.method = METHOD_MONTECARLO;
+	else
+		ok = ok && (fields[11].empty() || parseCode(fields[11], method_names, METHOD_COUNT, trade.method));
+	ok = ok && parseNumber(fields[12], trade.rate) && parseList(fields[13], trade.spot, TRADE_MAX_ASSETS) && parseList(fields[14], trade.vol, TRADE_MAX_ASSETS);
+	ok = ok && parseNumber(fields[15], trade.corr) && parseNumber(fields[16], trade.v0) && parseNumber(fields[17], trade.kappa);
+	ok = ok && parseNumber(fields[18], trade.theta) && parseNumber(fields[19], trade.xi) && parseNumber(fields[20], trade.rho);
+	ok = ok && parseNumber(fields[21], trade.nb_simulations) && parseNumber(fields[22], trade.nb_steps) && parseNumber(fields[23], trade.target_rmse);
+
+	trade.monitored = monitored != 0;
+	if (trade.option == OPTION_SPREAD && fields[9].empty())
+		trade.size = 2;
+	return ok ? TRADE_OK : TRADE_PARSE_ERROR;
+}
+
+static bool isInteger(double x, double low, double high) {
+	return x >= low && x <= high && x == floor(x);
+}
+
+TradeStatus validateTrade(const TradeRecord& trade) {
+
+	/*
+		Rejects the records that the Option and Heston constructors would reject with "exit", and the models or methods that cannot price the Option.
+		The Monte-Carlo work of a record is bounded as well (TRADE_MAX_SIMULATIONS, TRADE_MAX_PATH_STEPS, TRADE_MIN_RELATIVE_RMSE) : a single row
+		must not keep a pricing thread busy for hours, while the ordered output waits for it.
+	*/
+
+	if (trade.option < 0 || trade.option >= OPTION_COUNT || trade.model < 0 || trade.model >= MODEL_COUNT || trade.method < 0 || trade.method >= METHOD_COUNT)
+		return TRADE_PARSE_ERROR;
+
+	// Contract terms
+	bool multi_asset = trade.option == OPTION_BASKET || trade.option == OPTION_SPREAD;
+	if ((trade.phi != 1 && trade.phi != -1) || !(trade.maturity > 0) || !(trade.strike >= 0))
+		return TRADE_INVALID_CONTRACT;
+	if (trade.option == OPTION_BARRIER) {
+		bool up = trade.barrier_type == BARRIER_UP_OUT || trade.barrier_type == BARRIER_UP_IN;
+		if (trade.barrier_type < 0 || trade.barrier_type >= BARRIER_COUNT || up != (trade.phi == 1))
+			return TRADE_INVALID_CONTRACT;
+		if ((trade.phi == 1 && trade.barrier < trade.strike) || (trade.phi == -1 && trade.barrier > trade.strike))
+			return TRADE_INVALID_CONTRACT;
+	}
+	if (trade.option == OPTION_ASIAN && !isInteger(trade.freq, 1, 1e6))
+		return TRADE_INVALID_CONTRACT;
+	if ((trade.option == OPTION_BASKET && !isInteger(trade.size, 1, TRADE_MAX_ASSETS)) || (trade.option == OPTION_SPREAD && trade.size != 2) || (!multi_asset && trade.size != 1))
+		return TRADE_INVALID_CONTRACT;
+
+	// Model parameters
+	if (!isfinite(trade.rate) || !(trade.corr >= -1 && trade.corr <= 1))
+		return TRADE_INVALID_MODEL;
+	for (int i = 0; i < trade.size; i++) {
+		bool vol_needed = trade.model == MODEL_BLACK; // The Heston records use v0 instead.
+		if (!(trade.spot[i] > 0 && trade.spot[i] < HUGE_VAL) || (vol_needed && !(trade.vol[i] > 0 && trade.vol[i] < HUGE_VAL)))
+			return TRADE_INVALID_MODEL;
+	}
+	if (trade.model == MODEL_HESTON && (!(trade.v0 >= 0) || !(trade.kappa > 0) || !(trade.theta >= 0) || !(trade.xi > 0) || !(trade.rho >= -1 && trade.rho <= 1)))
+		return TRADE_INVALID_MODEL;
+	if (trade.method != METHOD_ANALYTICAL && (!isInteger(trade.nb_simulations, 1, TRADE_MAX_SIMULATIONS) || !isInteger(trade.nb_steps, 1, 1e6)))
+		return TRADE_INVALID_MODEL;
+	if (trade.method == METHOD_MLMC && !(trade.target_rmse >= TRADE_MIN_RELATIVE_RMSE * trade.spot[0]))
+		return TRADE_INVALID_MODEL;
+
+	// Monte-Carlo work : the path-dependent Options simulate the steps and the fixings, the Heston paths the steps, the other paths one step
+	bool monitored_barrier = trade.option == OPTION_BARRIER && trade.monitored;
+	double path_steps = multi_asset ? trade.size : trade.model == MODEL_HESTON ? trade.nb_steps : 1;
+	if (trade.option == OPTION_ASIAN || monitored_barrier)
+		path_steps = trade.nb_steps + (trade.option == OPTION_ASIAN ? trade.freq : 0);
+	if (trade.method == METHOD_MONTECARLO && trade.nb_simulations * path_steps > TRADE_MAX_PATH_STEPS)
+		return TRADE_INVALID_MODEL;
+
+	// Methods available for the Option and the model
+	if (trade.model == MODEL_BLACK && trade.method == METHOD_ANALYTICAL && monitored_barrier)
+		return TRADE_UNSUPPORTED;
+	if (trade.model == MODEL_HESTON && (multi_asset || trade.method == METHOD_MLMC || (trade.method == METHOD_ANALYTICAL && trade.option != OPTION_VANILLA)))
+		return TRADE_UNSUPPORTED;
+	if (trade.method == METHOD_MLMC && multi_asset)
+		return TRADE_UNSUPPORTED;
+	return TRADE_OK;
+}
+
+static double priceSingleAsset(const TradeRecord& trade, Option* opt, BlackScholesModel* bs_model, MonteCarlo& mc) {
+
+	/* Single-asset Options : the BS model is replaced by the Heston model for the Heston records. */
+
+	if (trade.model == MODEL_HESTON) {
+		HestonModel heston(trade.rate, trade.spot[0], trade.v0, trade.kappa, trade.theta, trade.xi, trade.rho);
+		return trade.method == METHOD_ANALYTICAL ? heston.price(opt) : mc.price(&heston, opt);
+	}
+	if (trade.method == METHOD_ANALYTICAL)
+		return bs_model->price(opt);
+	if (trade.method == METHOD_MLMC)
+		return mc.priceMLMC(bs_model, opt, trade.target_rmse);
+	return mc.price(bs_model, opt);
+}
+
+TradeStatus priceTrade(const TradeRecord& trade, MonteCarlo& mc, double& price) {
+	/*
+		Builds the Option and the model of the record on the stack, and prices them with the record method.
+		Invalid records are not priced : their status is returned instead, and "price" is left unchanged.
+	*/
+	TradeStatus status = validateTrade(trade);
+	if (status != TRADE_OK)
+		return status;
+
+	mc.setNbSimulations(trade.nb_simulations);
+	mc.setNbSteps(trade.nb_steps);
+	double K = trade.strike;
+	double T = trade.maturity;
+	int phi = trade.phi;
+	double r = trade.rate;
+
+	switch (trade.option) {
+	case OPTION_VANILLA: {
+		VanillaOption opt(K, T, phi);
+		BlackVanilla bs_model(r, trade.spot[0], trade.vol[0]);
+		price = priceSingleAsset(trade, &opt, &bs_model, mc);
+		break;
+	}
+	case OPTION_DIGITAL: {
+		DigitalOption opt(K, T, phi);
+		BlackDigital bs_model(r, trade.spot[0], trade.vol[0]);
+		price = priceSingleAsset(trade, &opt, &bs_model, mc);
+		break;
+	}
+	case OPTION_BARRIER: {
+		BarrierOption opt(K, trade.barrier, T, phi, BARRIER_NAMES[trade.barrier_type], trade.monitored != 0);
+		BlackBarrier bs_model(r, trade.spot[0], trade.vol[0]);
+		price = priceSingleAsset(trade, &opt, &bs_model, mc);
+		break;
+	}
+	case OPTION_ASIAN: {
+		AsianOption opt(K, T, phi, trade.freq);
+		BlackAsian bs_model(r, trade.spot[0], trade.vol[0]);
+		price = priceSingleAsset(trade, &opt, &bs_model, mc);
+		break;
+	}
+	case OPTION_BASKET:
+	case OPTION_SPREAD: {
+		int d = (int)trade.size;
+		vector<double> spots(trade.spot, trade.spot + d);
+		vector<double> vols(trade.vol, trade.vol + d);
+		vector<vector<double>> corr_matrix(d, vector<double>(d, trade.corr));
+		for (int i = 0; i < d; i++)
+			corr_matrix[i][i] = 1;
+		if (trade.option == OPTION_BASKET) {
+			BasketOption opt(K, T, phi, d);
+			BlackBasket bs_model(r, d, spots, vols, corr_matrix);
+			price = trade.method == METHOD_ANALYTICAL ? bs_model.price(&opt) : mc.price(&bs_model, &opt);
+		}
+		else {
+			SpreadOption opt(K, T, phi);
+			BlackSpread bs_model(r, spots, vols, corr_matrix);
+			price = trade.method == METHOD_ANALYTICAL ? bs_model.price(&opt) : mc.price(&bs_model, &opt);
+		}
+		break;
+	}
+	}
+	return TRADE_OK;
+}
+
+void appendResultCSV(const ResultRecord& result, string& out) {
+
+	/* The price is left empty for the records that were not priced. */
+
+	char line[96];
+	int n;
+	if (result.status == TRADE_OK)
+		n = snprintf(line, sizeof(line), "%llu,%.12g,ok\n", (unsigned long long)result.id, result.price);
+	else
+		n = snprintf(line, sizeof(line), "%llu,,%s\n", (unsigned long long)result.id, tradeStatusName(result.status));
+	out.append(line, n);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "MonteCarlo.h"
+
+using namespace std;
+
+/*
+	The Header file of the "Trade" records of the batch pricer.
+	A "TradeRecord" holds a contract and its model parameters in a fixed-size, trivially copyable record : it is both the parsed
+	form of a CSV line and the compact binary record format (native byte order, read and written as raw bytes).
+	"priceTrade" builds the Option and the model on the stack from the record and prices it, without ever calling "exit".
+*/
+
+enum TradeOption : int32_t { OPTION_VANILLA, OPTION_DIGITAL, OPTION_BARRIER, OPTION_ASIAN, OPTION_BASKET, OPTION_SPREAD, OPTION_COUNT };
+enum TradeModel : int32_t { MODEL_BLACK, MODEL_HESTON, MODEL_COUNT };
+enum TradeMethod : int32_t { METHOD_ANALYTICAL, METHOD_MONTECARLO, METHOD_MLMC, METHOD_COUNT };
+enum TradeBarrier : int32_t { BARRIER_UP_OUT, BARRIER_UP_IN, BARRIER_DOWN_OUT, BARRIER_DOWN_IN, BARRIER_COUNT };
+enum TradeStatus : int32_t { TRADE_OK, TRADE_PARSE_ERROR, TRADE_INVALID_CONTRACT, TRADE_INVALID_MODEL, TRADE_UNSUPPORTED, TRADE_STATUS_COUNT };
+
+const int TRADE_MAX_ASSETS = 4; // Maximum number of underlyings of the Basket records.
+const double TRADE_MAX_SIMULATIONS = 1e8; // Maximum number of simulations of the Monte-Carlo records.
+const double TRADE_MAX_PATH_STEPS = 1e9; // Maximum simulated time steps (underlyings for the multi-asset Options) of a Monte-Carlo record, summed over its paths : about a minute of one pricing thread.
+const double TRADE_MIN_RELATIVE_RMSE = 1e-4; // Smallest MLMC target RMSE, relative to the spot : the number of paths grows as 1 / RMSE^2.
+
+struct TradeRecord {
+	uint64_t id = 0;
+	int32_t option = OPTION_VANILLA;
+	int32_t model = MODEL_BLACK;
+	int32_t method = METHOD_ANALYTICAL;
+	int32_t phi = 1; // +1 for Calls, -1 for Puts.
+	int32_t barrier_type = BARRIER_UP_OUT;
+	int32_t monitored = 0; // 1 for Barriers monitored continuously up to the maturity.
+	double strike = 0;
+	double maturity = 0;
+	double barrier = 0;
+	double freq = 1; // Asian fixings frequency.
+	double size = 1; // Number of underlyings : up to TRADE_MAX_ASSETS for Baskets, 2 for Spreads.
+	double rate = 0; // ZC Rate.
+	double spot[TRADE_MAX_ASSETS] = {};
+	double vol[TRADE_MAX_ASSETS] = {};
+	double corr = 0; // Correlation between every pair of underlyings.
+	double v0 = 0, kappa = 0, theta = 0, xi = 0, rho = 0; // Heston parameters.
+	double nb_simulations = 20000; // Monte-Carlo number of simulations.
+	double nb_steps = 1; // Monte-Carlo number of time steps.
+	double target_rmse = 0.01; // MLMC root mean square error.
+};
+
+struct ResultRecord {
+	uint64_t id = 0;
+	double price = 0;
+	int32_t status = TRADE_OK;
+	int32_t reserved = 0; // Padding, always 0.
+};
+
+static_assert(is_trivially_copyable<TradeRecord>::value && sizeof(TradeRecord) == 216, "TradeRecord is a binary record format.");
+static_assert(is_trivially_copyable<ResultRecord>::value && sizeof(ResultRecord) == 24, "ResultRecord is a binary record format.");
+
+const char* tradeStatusName(int32_t status); // "ok", "parse_error", "invalid_contract", "invalid_model", or "unsupported".
+bool isTradeCSVComment(const char* line, const char* end); // True for the empty lines, the "#" comments, and the header line.
+TradeStatus parseTradeCSV(const char* line, const char* end, TradeRecord& trade); // Parses a CSV line (see TRADE_CSV_HEADER) into the record.
+TradeStatus validateTrade(const TradeRecord& trade); // Checks the record before any Option or model is built.
+TradeStatus priceTrade(const TradeRecord& trade, MonteCarlo& mc, double& price); // Prices a valid record, "mc" is used by the Monte-Carlo methods.
+void appendResultCSV(const ResultRecord& result, string& out); // Appends the "id,price,status" line of the result, with its end of line.
+
+extern const char* TRADE_CSV_HEADER;
+extern const char* RESULT_CSV_HEADER;
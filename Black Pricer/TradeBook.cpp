@@ -0,0 +1,291 @@
+#include "TradeBook.h"
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "BlackScholesModel.h"
+#include "HestonModel.h"
+
+using namespace std;
+
+/*
+	The Source file of the columnar "TradeBook" files.
+*/
+
+const char BOOK_MAGIC[8] = { 'B', 'P', 'B', 'O', 'O', 'K', '0', '1' };
+const char RESULT_MAGIC[8] = { 'B', 'P', 'R', 'S', 'L', 'T', '0', '1' };
+const size_t COLUMN_SIZES[BOOK_COLUMN_COUNT] = { sizeof(uint64_t), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(int8_t), sizeof(uint8_t), sizeof(uint32_t) };
+const uint64_t PRICING_BLOCK = 4096; // Trades handed to a pricing thread at once.
+const uint32_t NO_HESTON_MODEL = 0xFFFFFFFF; // Model table rows without a valid Heston model.
+
+static uint64_t align(uint64_t offset) {
+	return (offset + BOOK_ALIGNMENT - 1) / BOOK_ALIGNMENT * BOOK_ALIGNMENT;
+}
+
+static string column_path(const string& path, int c) {
+	return path + ".column" + to_string(c) + ".tmp";
+}
+
+TradeBookWriter::TradeBookWriter(const string& book_path) {
+
+	/* Book writer constructor : opens the temporary column files. */
+
+	path = book_path;
+	columns.resize(BOOK_COLUMN_COUNT);
+	for (int c = 0; c < BOOK_COLUMN_COUNT; c++) {
+		columns[c].open(column_path(path, c), ios::binary | ios::trunc);
+		failed = failed || !columns[c];
+	}
+}
+
+TradeBookWriter::~TradeBookWriter() {
+	for (int c = 0; c < BOOK_COLUMN_COUNT; c++) {
+		if (columns[c].is_open()) {
+			columns[c].close();
+			remove(column_path(path, c).c_str());
+		}
+	}
+}
+
+template <typename T>
+static void write_value(ofstream& column, T value) {
+	column.write((const char*)&value, sizeof(T));
+}
+
+TradeStatus TradeBookWriter::add(const TradeRecord& trade) {
+	/*
+		The books hold the single-asset trades of the analytical methods : Vanillas, Digitals, Asians and European Barriers under the BS model,
+		and Vanillas under the Heston model. The other trades are refused with TRADE_UNSUPPORTED.
+	*/
+	TradeStatus status = validateTrade(trade);
+	if (status != TRADE_OK)
+		return status;
+	if (trade.method != METHOD_ANALYTICAL || trade.option == OPTION_BASKET || trade.option == OPTION_SPREAD || (trade.option == OPTION_BARRIER && trade.monitored))
+		return TRADE_UNSUPPORTED;
+
+	uint8_t type = BOOK_VANILLA;
+	if (trade.option == OPTION_DIGITAL)
+		type = BOOK_DIGITAL;
+	else if (trade.option == OPTION_ASIAN)
+		type = BOOK_ASIAN;
+	else if (trade.option == OPTION_BARRIER)
+		type = (uint8_t)(BOOK_UP_OUT + trade.barrier_type);
+
+	BookModel model;
+	model.model = trade.model;
+	model.rate = trade.rate;
+	model.spot = trade.spot[0];
+	if (trade.model == MODEL_BLACK)
+		model.vol = trade.vol[0];
+	else {
+		model.v0 = trade.v0;
+		model.kappa = trade.kappa;
+		model.theta = trade.theta;
+		model.xi = trade.xi;
+		model.rho = trade.rho;
+	}
+	auto key = make_tuple(model.model, model.rate, model.spot, model.vol, model.v0, model.kappa, model.theta, model.xi, model.rho);
+	auto it = modelIndex.find(key);
+	if (it == modelIndex.end()) {
+		it = modelIndex.emplace(key, (uint32_t)models.size()).first;
+		models.push_back(model);
+	}
+
+	write_value(columns[COLUMN_ID], trade.id);
+	write_value(columns[COLUMN_STRIKE], trade.strike);
+	write_value(columns[COLUMN_MATURITY], trade.maturity);
+	write_value(columns[COLUMN_BARRIER], trade.barrier);
+	write_value(columns[COLUMN_FREQ], trade.freq);
+	write_value(columns[COLUMN_PHI], (int8_t)trade.phi);
+	write_value(columns[COLUMN_TYPE], type);
+	write_value(columns[COLUMN_MODEL], it->second);
+	nbTrades++;
+	return TRADE_OK;
+}
+
+bool TradeBookWriter::close() {
+
+	/* Header, model table, and the temporary columns copied one after the other at their aligned offsets. */
+
+	BookHeader header;
+	memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+	header.nbTrades = nbTrades;
+	header.nbModels = models.size();
+	header.modelsOffset = align(sizeof(BookHeader));
+	uint64_t offset = align(header.modelsOffset + models.size() * sizeof(BookModel));
+	for (int c = 0; c < BOOK_COLUMN_COUNT; c++) {
+		header.columnOffsets[c] = offset;
+		offset = align(offset + nbTrades * COLUMN_SIZES[c]);
+	}
+
+	ofstream book(path, ios::binary | ios::trunc);
+	auto pad_to = [&book](uint64_t position) {
+		static const char zeros[BOOK_ALIGNMENT] = {};
+		book.write(zeros, position - (uint64_t)book.tellp());
+	};
+	book.write((const char*)&header, sizeof(header));
+	pad_to(header.modelsOffset);
+	book.write((const char*)models.data(), models.size() * sizeof(BookModel));
+	for (int c = 0; c < BOOK_COLUMN_COUNT; c++) {
+		pad_to(header.columnOffsets[c]);
+		columns[c].close();
+		failed = failed || !columns[c];
+		ifstream column(column_path(path, c), ios::binary);
+		if (nbTrades > 0)
+			book << column.rdbuf();
+		column.close();
+		remove(column_path(path, c).c_str());
+	}
+	pad_to(offset);
+	return !failed && book.good();
+}
+
+TradeBook::TradeBook(const string& path) : file(path) {
+
+	/* Maps the book, and checks its header and the bounds of its columns. */
+
+	if (!file.isOpen()) {
+		error = file.getError();
+		return;
+	}
+	const BookHeader* h = (const BookHeader*)file.getData();
+	if (file.getSize() < sizeof(BookHeader) || memcmp(h->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0) {
+		error = path + " is not a trade book";
+		return;
+	}
+	bool in_bounds = h->modelsOffset % BOOK_ALIGNMENT == 0 && h->modelsOffset + h->nbModels * sizeof(BookModel) <= file.getSize();
+	for (int c = 0; c < BOOK_COLUMN_COUNT; c++)
+		in_bounds = in_bounds && h->columnOffsets[c] % BOOK_ALIGNMENT == 0 && h->columnOffsets[c] + h->nbTrades * COLUMN_SIZES[c] <= file.getSize();
+	if (!in_bounds) {
+		error = path + " is truncated";
+		return;
+	}
+	header = h;
+}
+
+uint64_t TradeBook::price(ResultBook& results, int nb_threads) const {
+	/*
+		Prices every trade of the book into the result columns. The models are built once per row of the model table, and each trade is priced
+		from its columns with the contract terms overloads of the models. The pricing threads take blocks of PRICING_BLOCK trades in turn,
+		as the Heston trades cost much more than the BS ones, and write their disjoint slices of the mapped result columns.
+	*/
+	uint64_t n = getNbTrades();
+	double* prices = results.getWritablePrices();
+	int8_t* status = results.getWritableStatus();
+	if (!prices || results.getNbTrades() != n)
+		return n;
+
+	const BookModel* models = getModels();
+	uint64_t nb_models = getNbModels();
+	vector<BlackVanilla> vanilla;
+	vector<BlackDigital> digital;
+	vector<BlackBarrier> barrier;
+	vector<BlackAsian> asian;
+	vector<HestonModel> heston;
+	vector<uint32_t> heston_index(nb_models, NO_HESTON_MODEL); // Row of the Heston model in "heston".
+	for (uint64_t m = 0; m < nb_models; m++) {
+		const BookModel& p = models[m];
+		vanilla.emplace_back(p.rate, p.spot, p.vol);
+		digital.emplace_back(p.rate, p.spot, p.vol);
+		barrier.emplace_back(p.rate, p.spot, p.vol);
+		asian.emplace_back(p.rate, p.spot, p.vol);
+		// The Heston constructor exits on invalid parameters, and the book may not come from a "TradeBookWriter" : they are checked first
+		if (p.model == MODEL_HESTON && p.v0 >= 0 && p.kappa > 0 && p.theta >= 0 && p.xi > 0 && p.rho >= -1 && p.rho <= 1) {
+			heston_index[m] = (uint32_t)heston.size();
+			heston.emplace_back(p.rate, p.spot, p.v0, p.kappa, p.theta, p.xi, p.rho);
+		}
+	}
+
+	const double* K = getStrikes();
+	const double* T = getMaturities();
+	const double* B = getBarriers();
+	const double* freq = getFreqs();
+	const int8_t* phi = getPhis();
+	const uint8_t* type = getTypes();
+	const uint32_t* model = getModelIndices();
+
+	atomic<uint64_t> next_block(0);
+	atomic<uint64_t> errors(0);
+	auto price_blocks = [&] {
+		uint64_t block_errors = 0;
+		for (uint64_t begin = next_block.fetch_add(PRICING_BLOCK); begin < n; begin = next_block.fetch_add(PRICING_BLOCK)) {
+			uint64_t end = min(n, begin + PRICING_BLOCK);
+			for (uint64_t i = begin; i < end; i++) {
+				uint32_t m = model[i];
+				TradeStatus s = TRADE_OK;
+				double p = 0;
+				if (m >= nb_models || type[i] >= BOOK_TYPE_COUNT || (phi[i] != 1 && phi[i] != -1))
+					s = TRADE_PARSE_ERROR;
+				else if (models[m].model == MODEL_HESTON) {
+					if (heston_index[m] == NO_HESTON_MODEL)
+						s = TRADE_INVALID_MODEL;
+					else if (type[i] == BOOK_VANILLA)
+						p = heston[heston_index[m]].price(K[i], T[i], phi[i]);
+					else
+						s = TRADE_UNSUPPORTED;
+				}
+				else {
+					switch (type[i]) {
+					case BOOK_VANILLA: p = vanilla[m].price(K[i], T[i], phi[i]); break;
+					case BOOK_DIGITAL: p = digital[m].price(K[i], T[i], phi[i]); break;
+					case BOOK_ASIAN: p = asian[m].price(K[i], T[i], phi[i], freq[i]); break;
+					case BOOK_UP_OUT:
+					case BOOK_DOWN_OUT: p = barrier[m].price(K[i], B[i], T[i], phi[i], false); break;
+					case BOOK_UP_IN:
+					case BOOK_DOWN_IN: p = barrier[m].price(K[i], B[i], T[i], phi[i], true); break;
+					}
+				}
+				prices[i] = p;
+				status[i] = (int8_t)s;
+				block_errors += s != TRADE_OK;
+			}
+		}
+		errors += block_errors;
+	};
+
+	int threads = nb_threads > 0 ? nb_threads : max(1, (int)thread::hardware_concurrency());
+	vector<thread> workers;
+	for (int t = 1; t < threads; t++)
+		workers.emplace_back(price_blocks);
+	price_blocks();
+	for (thread& worker : workers)
+		worker.join();
+	return errors;
+}
+
+ResultBook::ResultBook(const string& path, uint64_t nb_trades) : file(path, align(align(sizeof(ResultHeader)) + nb_trades * sizeof(double)) + nb_trades) {
+
+	/* Creates the mapped result file, and writes its header. The result columns are filled by the pricing. */
+
+	if (!file.isOpen()) {
+		error = file.getError();
+		return;
+	}
+	ResultHeader* h = (ResultHeader*)file.getWritableData();
+	memcpy(h->magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+	h->nbTrades = nb_trades;
+	h->priceOffset = align(sizeof(ResultHeader));
+	h->statusOffset = align(h->priceOffset + nb_trades * sizeof(double));
+	header = h;
+}
+
+ResultBook::ResultBook(const string& path) : file(path) {
+
+	/* Maps an existing result file, and checks its header. */
+
+	if (!file.isOpen()) {
+		error = file.getError();
+		return;
+	}
+	ResultHeader* h = (ResultHeader*)file.getData();
+	if (file.getSize() < sizeof(ResultHeader) || memcmp(h->magic, RESULT_MAGIC, sizeof(RESULT_MAGIC)) != 0) {
+		error = path + " is not a result file";
+		return;
+	}
+	if (h->priceOffset + h->nbTrades * sizeof(double) > file.getSize() || h->statusOffset + h->nbTrades > file.getSize()) {
+		error = path + " is truncated";
+		return;
+	}
+	header = h;
+}
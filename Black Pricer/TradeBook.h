@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <fstream>
+#include "MappedFile.h"
+#include "Trade.h"
+
+using namespace std;
+
+/*
+	The Header file of the columnar "TradeBook" files.
+	A book file holds the single-asset trades priced with the analytical methods, one column per contract field, and a table of model
+	parameters indexed by the "model" column. The books and their result files are memory-mapped : the pricing reads the columns
+	and writes the result columns in place, without building any Option, so loading and saving a book costs only page faults.
+	Layout (native byte order) : the header, then the model table and the columns, each aligned on BOOK_ALIGNMENT bytes.
+*/
+
+const uint64_t BOOK_ALIGNMENT = 64;
+
+class ResultBook;
+
+enum BookType : uint8_t { BOOK_VANILLA, BOOK_DIGITAL, BOOK_ASIAN, BOOK_UP_OUT, BOOK_UP_IN, BOOK_DOWN_OUT, BOOK_DOWN_IN, BOOK_TYPE_COUNT };
+enum BookColumn { COLUMN_ID, COLUMN_STRIKE, COLUMN_MATURITY, COLUMN_BARRIER, COLUMN_FREQ, COLUMN_PHI, COLUMN_TYPE, COLUMN_MODEL, BOOK_COLUMN_COUNT };
+
+struct BookModel {
+	int32_t model = MODEL_BLACK;
+	int32_t reserved = 0; // Padding, always 0.
+	double rate = 0;
+	double spot = 0;
+	double vol = 0; // Black volatility.
+	double v0 = 0, kappa = 0, theta = 0, xi = 0, rho = 0; // Heston parameters.
+};
+
+struct BookHeader {
+	char magic[8]; // "BPBOOK01".
+	uint64_t nbTrades;
+	uint64_t nbModels;
+	uint64_t modelsOffset; // Byte offset of the BookModel table.
+	uint64_t columnOffsets[BOOK_COLUMN_COUNT]; // Byte offsets of the columns : uint64 ids, double strikes, maturities, barriers and freqs, int8 phis, uint8 types, uint32 model indices.
+};
+
+struct ResultHeader {
+	char magic[8]; // "BPRSLT01".
+	uint64_t nbTrades;
+	uint64_t priceOffset; // Byte offset of the double prices.
+	uint64_t statusOffset; // Byte offset of the int8 TradeStatus.
+};
+
+class TradeBookWriter {
+	/*
+		Builds a book file from "TradeRecord"s. The columns are streamed to temporary files next to the book, and concatenated by "close" :
+		the memory only grows with the number of distinct models.
+	*/
+private :
+	string path;
+	uint64_t nbTrades = 0;
+	vector<BookModel> models;
+	map<tuple<int32_t, double, double, double, double, double, double, double, double>, uint32_t> modelIndex; // Deduplication of the model parameters.
+	vector<ofstream> columns;
+	bool failed = false;
+public :
+	TradeBookWriter(const string& book_path);
+	~TradeBookWriter();
+	TradeStatus add(const TradeRecord& trade); // Appends a trade, or returns why it cannot be stored in a book.
+	bool close(); // Writes the book file and removes the temporary files.
+	uint64_t getNbTrades() { return nbTrades; };
+	uint64_t getNbModels() { return models.size(); };
+};
+
+class TradeBook {
+	/* Read-only view of a mapped book file. */
+private :
+	MappedFile file;
+	const BookHeader* header = nullptr;
+	string error;
+	template <typename T> const T* column(BookColumn c) const { return (const T*)(file.getData() + header->columnOffsets[c]); };
+public :
+	TradeBook(const string& path);
+	bool isOpen() { return header != nullptr; };
+	string getError() { return error; };
+	uint64_t getNbTrades() const { return header->nbTrades; };
+	uint64_t getNbModels() const { return header->nbModels; };
+	const BookModel* getModels() const { return (const BookModel*)(file.getData() + header->modelsOffset); };
+	const uint64_t* getIds() const { return column<uint64_t>(COLUMN_ID); };
+	const double* getStrikes() const { return column<double>(COLUMN_STRIKE); };
+	const double* getMaturities() const { return column<double>(COLUMN_MATURITY); };
+	const double* getBarriers() const { return column<double>(COLUMN_BARRIER); };
+	const double* getFreqs() const { return column<double>(COLUMN_FREQ); };
+	const int8_t* getPhis() const { return column<int8_t>(COLUMN_PHI); };
+	const uint8_t* getTypes() const { return column<uint8_t>(COLUMN_TYPE); };
+	const uint32_t* getModelIndices() const { return column<uint32_t>(COLUMN_MODEL); };
+	uint64_t price(ResultBook& results, int nb_threads = 0) const; // Prices every trade into the result columns, returns the number of errors.
+};
+
+class ResultBook {
+	/* Mapped result file : created read-write for the pricing, or opened read-only to read the results. */
+private :
+	MappedFile file;
+	ResultHeader* header = nullptr;
+	string error;
+public :
+	ResultBook(const string& path, uint64_t nb_trades); // Creates the result file of a book of "nb_trades" trades.
+	ResultBook(const string& path); // Opens an existing result file, read-only.
+	bool isOpen() { return header != nullptr; };
+	string getError() { return error; };
+	uint64_t getNbTrades() const { return header->nbTrades; };
+	const double* getPrices() const { return (const double*)((const char*)header + header->priceOffset); };
+	const int8_t* getStatus() const { return (const int8_t*)((const char*)header + header->statusOffset); };
+	double* getWritablePrices() { return file.getWritableData() ? (double*)((char*)header + header->priceOffset) : nullptr; };
+	int8_t* getWritableStatus() { return file.getWritableData() ? (int8_t*)((char*)header + header->statusOffset) : nullptr; };
+	bool flush() { return file.flush(); };
+};
@@ -1,84 +1,116 @@
 #include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
 #include "Option.h"
 #include "BlackScholesModel.h"
 #include "MultiAssetBSModel.h"
+#include "HestonModel.h"
 #include "MonteCarlo.h"
+#include "Instrumentation.h"
+#include "BatchPricer.h"
+#include "TradeBook.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 using namespace std;
 
-int main() {
+int runDemo() {
+	
+	/* The demonstration prices : Monte-Carlo prices against the analytical prices of every Option flavor. */
+
 	double rate = 0.05;
 	double vol = 0.3;
 	double spot = 100;
 
 	MonteCarlo mc(100000); // Number of Simulation = 100 000.
 	MonteCarlo mc_path_dep(30000, 10); // Path-Dependent MC : Number of Simulation = 30 000 & Number of Time Steps = 10.
+	MonteCarlo mc_monitored(30000, 10); // Monitored Barrier MC : Number of Simulation = 30 000 & Number of Time Steps = 10.
+	MonteCarlo mc_single(100000); // Single precision paths MC : Number of Simulation = 100 000.
+	mc_single.setSinglePrecision(true);
+	MonteCarlo mc_path_dep_single(30000, 10); // Path-Dependent MC on single precision paths.
+	mc_path_dep_single.setSinglePrecision(true);
 	
 	cout << "*********************** Vanilla Call ***********************" << endl;
-	Option* call_vanilla = new VanillaOption(105, 1, -1); 
-	BlackVanilla* bs_vanilla = new BlackVanilla(rate, spot, vol);
-	cout << "Monte Carlo Price : " << mc.price(bs_vanilla, call_vanilla) << endl;
-	cout << "Analytical Price : " << bs_vanilla->price(call_vanilla) << endl;
+	VanillaOption call_vanilla(105, 1, -1);
+	BlackVanilla bs_vanilla(rate, spot, vol);
+	cout << "Monte Carlo Price : " << mc.price(&bs_vanilla, &call_vanilla) << endl;
+	cout << "Monte Carlo Price (Single Precision) : " << mc_single.price(&bs_vanilla, &call_vanilla) << endl;
+	cout << "Analytical Price : " << bs_vanilla.price(&call_vanilla) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** Vanilla Put ************************" << endl;
-	Option* put_vanilla = new VanillaOption(95, 1, -1);
-	cout << "Monte Carlo Price : " << mc.price(bs_vanilla, put_vanilla) << endl;
-	cout << "Analytical Price : " << bs_vanilla->price(put_vanilla) << endl;
+	VanillaOption put_vanilla(95, 1, -1);
+	cout << "Monte Carlo Price : " << mc.price(&bs_vanilla, &put_vanilla) << endl;
+	cout << "Analytical Price : " << bs_vanilla.price(&put_vanilla) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 
 	cout << "*********************** Digital Call ***********************" << endl;
-	Option* call_digital = new DigitalOption(105, 1, 1);
-	BlackDigital* bs_digital = new BlackDigital(rate, spot, vol);
-	cout << "Monte Carlo Price : " << mc.price(bs_digital, call_digital) << endl;
-	cout << "Analytical Price : " << bs_digital->price(call_digital) << endl;
+	DigitalOption call_digital(105, 1, 1);
+	BlackDigital bs_digital(rate, spot, vol);
+	cout << "Monte Carlo Price : " << mc.price(&bs_digital, &call_digital) << endl;
+	cout << "Analytical Price : " << bs_digital.price(&call_digital) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** Digital Put ************************" << endl;
-	Option* put_digital = new DigitalOption(95, 1, -1);
-	cout << "Monte Carlo Price : " << mc.price(bs_digital, put_digital) << endl;
-	cout << "Analytical Price : " << bs_digital->price(put_digital) << endl;
+	DigitalOption put_digital(95, 1, -1);
+	cout << "Monte Carlo Price : " << mc.price(&bs_digital, &put_digital) << endl;
+	cout << "Analytical Price : " << bs_digital.price(&put_digital) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 
 	cout << "*********************** UP & OUT Call **********************" << endl;
-	Option* call_upout = new BarrierOption(105, 145, 1, 1, "Up Out");
-	BlackBarrier* bs_barrier = new BlackBarrier(rate, spot, vol);
-	cout << "Monte Carlo Price : " << mc.price(bs_barrier, call_upout) << endl;
-	cout << "Analytical Price : " << bs_barrier->price(call_upout) << endl;
+	BarrierOption call_upout(105, 145, 1, 1, "Up Out");
+	BlackBarrier bs_barrier(rate, spot, vol);
+	cout << "Monte Carlo Price : " << mc.price(&bs_barrier, &call_upout) << endl;
+	cout << "Analytical Price : " << bs_barrier.price(&call_upout) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** UP & IN Call ***********************" << endl;
-	Option* call_upin = new BarrierOption(105, 145, 1, 1, "Up In");
-	cout << "Monte Carlo Price : " << mc.price(bs_barrier, call_upin) << endl;
-	cout << "Analytical Price : " << bs_barrier->price(call_upin) << endl;
+	BarrierOption call_upin(105, 145, 1, 1, "Up In");
+	cout << "Monte Carlo Price : " << mc.price(&bs_barrier, &call_upin) << endl;
+	cout << "Analytical Price : " << bs_barrier.price(&call_upin) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** DONW & OUT Put *********************" << endl;
-	Option* put_downout = new BarrierOption(105, 65, 1, -1, "Down Out");
-	cout << "Monte Carlo Price : " << mc.price(bs_barrier, put_downout) << endl;
-	cout << "Analytical Price : " << bs_barrier->price(put_downout) << endl;
+	BarrierOption put_downout(105, 65, 1, -1, "Down Out");
+	cout << "Monte Carlo Price : " << mc.price(&bs_barrier, &put_downout) << endl;
+	cout << "Analytical Price : " << bs_barrier.price(&put_downout) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** DOWN & IN Put **********************" << endl;
-	Option* put_downin = new BarrierOption(105, 65, 1, -1, "Down In");
-	cout << "Monte Carlo Price : " << mc.price(bs_barrier, put_downin) << endl;
-	cout << "Analytical Price : " << bs_barrier->price(put_downin) << endl;
+	BarrierOption put_downin(105, 65, 1, -1, "Down In");
+	cout << "Monte Carlo Price : " << mc.price(&bs_barrier, &put_downin) << endl;
+	cout << "Analytical Price : " << bs_barrier.price(&put_downin) << endl;
+	cout << "************************************************************" << endl;
+	cout << endl;
+	cout << "***************** Monitored UP & OUT Call ******************" << endl;
+	BarrierOption call_upout_monitored(105, 145, 1, 1, "Up Out", true);
+	cout << "Monte Carlo Price (continuous monitoring, 10 steps) : " << mc_monitored.price(&bs_barrier, &call_upout_monitored) << endl;
+	cout << "Multilevel Monte Carlo Price (continuous monitoring) : " << mc_monitored.priceMLMC(&bs_barrier, &call_upout_monitored, 0.1) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 
 	cout << "*********************** Asian Call *************************" << endl;
-	Option* call_asian = new AsianOption(105, 1, 1, 4);
-	BlackAsian* bs_asian = new BlackAsian(rate, spot, vol);
-	cout << "Monte Carlo Price : " << mc_path_dep.price(bs_asian, call_asian) << endl;
-	cout << "Analytical Price : " << bs_asian->price(call_asian) << endl;
+	AsianOption call_asian(105, 1, 1, 4);
+	BlackAsian bs_asian(rate, spot, vol);
+	cout << "Monte Carlo Price : " << mc_path_dep.price(&bs_asian, &call_asian) << endl;
+	cout << "Multilevel Monte Carlo Price : " << mc_path_dep.priceMLMC(&bs_asian, &call_asian, 0.05) << endl;
+	cout << "Monte Carlo Price (Single Precision) : " << mc_path_dep_single.price(&bs_asian, &call_asian) << endl;
+	cout << "Analytical Price : " << bs_asian.price(&call_asian) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** Asian Put **************************" << endl;
-	Option* put_asian = new AsianOption(95, 1, -1, 4);
-	cout << "Monte Carlo Price : " << mc_path_dep.price(bs_asian, put_asian) << endl;
-	cout << "Analytical Price : " << bs_asian->price(put_asian) << endl;
+	AsianOption put_asian(95, 1, -1, 4);
+	cout << "Monte Carlo Price : " << mc_path_dep.price(&bs_asian, &put_asian) << endl;
+	cout << "Analytical Price : " << bs_asian.price(&put_asian) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 
@@ -88,16 +120,17 @@ int main() {
 	vector<vector<double>> corr_matrix = { {1, -0.6, 0.3}, {-0.6, 1, -0.2}, {0.3, -0.2, 1} };
 
 	cout << "*********************** Basket Call ************************" << endl;
-	Option* call_basket = new BasketOption(100, 1, 1, size);
-	MultiAssetBSModel* bs_basket = new BlackBasket(rate, size, spots, vols, corr_matrix);
-	cout << "Monte Carlo Price : " << mc.price(bs_basket, call_basket) << endl;
-	cout << "Analytical Price : " << bs_basket->price(call_basket) << endl;
+	BasketOption call_basket(100, 1, 1, size);
+	BlackBasket bs_basket(rate, size, spots, vols, corr_matrix);
+	cout << "Monte Carlo Price : " << mc.price(&bs_basket, &call_basket) << endl;
+	cout << "Monte Carlo Price (Single Precision) : " << mc_single.price(&bs_basket, &call_basket) << endl;
+	cout << "Analytical Price : " << bs_basket.price(&call_basket) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** Basket Put *************************" << endl;
-	Option* put_basket = new BasketOption(100, 1, -1, size);
-	cout << "Monte Carlo Price : " << mc.price(bs_basket, put_basket) << endl;
-	cout << "Analytical Price : " << bs_basket->price(put_basket) << endl;
+	BasketOption put_basket(100, 1, -1, size);
+	cout << "Monte Carlo Price : " << mc.price(&bs_basket, &put_basket) << endl;
+	cout << "Analytical Price : " << bs_basket.price(&put_basket) << endl;
 	cout << "************************************************************" << endl;
 	cout << endl;
 
@@ -106,18 +139,239 @@ int main() {
 	corr_matrix = { {1, 0.3}, {0.3, 1} };
 
 	cout << "*********************** Spread Call **************************" << endl;
-	Option* call_spread = new SpreadOption(15, 1, 1);
-	MultiAssetBSModel* bs_spread = new BlackSpread(rate, spots, vols, corr_matrix);
-	cout << "Monte Carlo Price : " << mc.price(bs_spread, call_spread) << endl;
-	cout << "Analytical Price : " << bs_spread->price(call_spread) << endl;
+	SpreadOption call_spread(15, 1, 1);
+	BlackSpread bs_spread(rate, spots, vols, corr_matrix);
+	cout << "Monte Carlo Price : " << mc.price(&bs_spread, &call_spread) << endl;
+	cout << "Analytical Price : " << bs_spread.price(&call_spread) << endl;
+	cout << "Quadrature Price : " << bs_spread.priceQuadrature(&call_spread) << endl;
 	cout << "**************************************************************" << endl;
 	cout << endl;
 	cout << "*********************** Spread Put ***************************" << endl;
-	Option* put_spread = new SpreadOption(5, 1, -1);
-	cout << "Monte Carlo Price : " << mc.price(bs_spread, put_spread) << endl;
-	cout << "Analytical Price : " << bs_spread->price(put_spread) << endl;
+	SpreadOption put_spread(5, 1, -1);
+	cout << "Monte Carlo Price : " << mc.price(&bs_spread, &put_spread) << endl;
+	cout << "Analytical Price : " << bs_spread.price(&put_spread) << endl;
+	cout << "Quadrature Price : " << bs_spread.priceQuadrature(&put_spread) << endl;
 	cout << "**************************************************************" << endl;
 	cout << endl;
 
+	MonteCarlo mc_heston(100000, 4); // Heston MC : Number of Simulation = 100 000 & Number of Time Steps = 4 (QE scheme).
+
+	cout << "*********************** Heston Vanilla Call ******************" << endl;
+	VanillaOption call_heston(105, 1, 1);
+	HestonModel heston(rate, spot, 0.09, 1.5, 0.09, 0.8, -0.7);
+	cout << "Monte Carlo Price : " << mc_heston.price(&heston, &call_heston, false) << endl;
+	cout << "Semi-Analytical Price : " << heston.price(&call_heston) << endl;
+	cout << "**************************************************************" << endl;
+	cout << endl;
+	cout << "*********************** Heston UP & OUT Call *****************" << endl;
+	BarrierOption call_upout_heston(105, 145, 1, 1, "Up Out");
+	cout << "Monte Carlo Price : " << mc_heston.price(&heston, &call_upout_heston, false) << endl;
+	cout << "Monte Carlo Price (Vanilla Control Variate) : " << mc_heston.price(&heston, &call_upout_heston) << endl;
+	cout << "**************************************************************" << endl;
+	cout << endl;
+
+	return 0;
+}
+
+void printUsage() {
+	cerr << "Usage : black_pricer [options] input" << endl;
+	cerr << "        black_pricer [--input-format csv|bin] --make-book BOOK input" << endl;
+	cerr << "        black_pricer [--threads N] --book BOOK -o RESULTS" << endl;
+	cerr << "        black_pricer --demo" << endl;
+	cerr << endl;
+	cerr << "Prices the trades of \"input\" (\"-\" for the standard input) and writes one result per trade, in input order." << endl;
+	cerr << "  -o, --output FILE        Output file. Default : the standard output." << endl;
+	cerr << "  --input-format csv|bin   CSV lines (" << TRADE_CSV_HEADER << ") or binary TradeRecords. Default : csv." << endl;
+	cerr << "  --output-format csv|bin  CSV lines (" << RESULT_CSV_HEADER << ") or binary ResultRecords. Default : csv." << endl;
+	cerr << "  --convert                Writes the valid trades as binary TradeRecords instead of pricing them." << endl;
+	cerr << "  --threads N              Pricing threads. Default : the number of hardware threads." << endl;
+	cerr << "  --chunk N                Trades per chunk. Default : 256." << endl;
+	cerr << "  --chunks N               Chunks in flight, which bounds the memory. Default : 4 per pricing thread." << endl;
+	cerr << "  --make-book BOOK         Writes the analytical single-asset trades of \"input\" in the columnar book file BOOK." << endl;
+	cerr << "  --book BOOK              Prices the mapped book file BOOK into the mapped result file given by -o." << endl;
+	cerr << "  --demo                   Prints the demonstration prices." << endl;
+}
+
+bool parseFormat(const char* name, BatchFormat& format) {
+	if (strcmp(name, "csv") == 0)
+		format = FORMAT_CSV;
+	else if (strcmp(name, "bin") == 0)
+		format = FORMAT_BINARY;
+	else
+		return false;
+	return true;
+}
+
+int makeBook(istream& in, BatchFormat format, const string& book_path) {
+
+	/* Columnar book of the input trades : the trades that a book cannot hold are counted and skipped. */
+
+	auto start = chrono::steady_clock::now();
+	TradeBookWriter writer(book_path);
+	uint64_t skipped = 0;
+	TradeRecord trade;
+	if (format == FORMAT_BINARY) {
+		while (in.read((char*)&trade, sizeof(trade)))
+			skipped += writer.add(trade) != TRADE_OK;
+	}
+	else {
+		string line;
+		while (getline(in, line)) {
+			const char* begin = line.data();
+			const char* end = begin + line.size();
+			if (!isTradeCSVComment(begin, end))
+				skipped += parseTradeCSV(begin, end, trade) != TRADE_OK || writer.add(trade) != TRADE_OK;
+		}
+	}
+	bool written = writer.close();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cerr << writer.getNbTrades() << " trades and " << writer.getNbModels() << " models written, " << skipped << " trades skipped, " << seconds << " s" << endl;
+	if (!written)
+		cerr << "Cannot write the book file " << book_path << endl;
+	return written ? 0 : 1;
+}
+
+int priceBook(const string& book_path, const string& result_path, int nb_threads) {
+
+	/* Mapped book pricing : the trades are read from the book columns, and the prices written in the result columns. */
+
+	auto start = chrono::steady_clock::now();
+	TradeBook book(book_path);
+	if (!book.isOpen()) {
+		cerr << book.getError() << endl;
+		return 1;
+	}
+	ResultBook results(result_path, book.getNbTrades());
+	if (!results.isOpen()) {
+		cerr << results.getError() << endl;
+		return 1;
+	}
+	uint64_t errors = book.price(results, nb_threads);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cerr << book.getNbTrades() << " trades, " << errors << " errors, " << seconds << " s (" << book.getNbTrades() / max(seconds, 1e-9) << " trades/s)" << endl;
 	return 0;
-}
\ No newline at end of file
+}
+
+void dumpInstrumentation() {
+
+	/* Instrumentation dump : the environment variables BLACKPRICER_STATS and BLACKPRICER_TRACE give the output files. */
+
+	if (getenv("BLACKPRICER_STATS")) {
+		ofstream stats_file(getenv("BLACKPRICER_STATS"));
+		Instrumentation::writeJSON(stats_file);
+	}
+	if (getenv("BLACKPRICER_TRACE")) {
+		ofstream trace_file(getenv("BLACKPRICER_TRACE"));
+		Instrumentation::writeTrace(trace_file);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	
+	/* Batch pricing driver : the trades are streamed from the input to the output through the "BatchPricer" pipeline. */
+
+	BatchPricer batch;
+	string input;
+	string output;
+	string make_book;
+	string book;
+	bool demo = false;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--demo")
+			demo = true;
+		else if ((arg == "-o" || arg == "--output") && has_value)
+			output = argv[++i];
+		else if (arg == "--input-format" && has_value) {
+			BatchFormat format;
+			if (!parseFormat(argv[++i], format)) {
+				printUsage();
+				return 1;
+			}
+			batch.setInputFormat(format);
+		}
+		else if (arg == "--output-format" && has_value) {
+			BatchFormat format;
+			if (!parseFormat(argv[++i], format)) {
+				printUsage();
+				return 1;
+			}
+			batch.setOutputFormat(format);
+		}
+		else if (arg == "--make-book" && has_value)
+			make_book = argv[++i];
+		else if (arg == "--book" && has_value)
+			book = argv[++i];
+		else if (arg == "--convert")
+			batch.setConvertOnly(true);
+		else if (arg == "--threads" && has_value)
+			batch.setNbThreads(max(1, atoi(argv[++i])));
+		else if (arg == "--chunk" && has_value)
+			batch.setChunkSize(max(1, atoi(argv[++i])));
+		else if (arg == "--chunks" && has_value)
+			batch.setNbChunks(max(1, atoi(argv[++i])));
+		else if (input.empty() && (arg == "-" || arg[0] != '-'))
+			input = arg;
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (demo) {
+		int status = runDemo();
+		dumpInstrumentation();
+		return status;
+	}
+	if (!book.empty()) {
+		if (output.empty() || !input.empty()) {
+			printUsage();
+			return 1;
+		}
+		int status = priceBook(book, output, batch.getNbThreads());
+		dumpInstrumentation();
+		return status;
+	}
+	if (input.empty()) {
+		printUsage();
+		return 1;
+	}
+
+	// Streams : the files get a large buffer, the standard streams are detached from the C streams
+	ios::sync_with_stdio(false);
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	vector<char> input_buffer(1 << 20);
+	vector<char> output_buffer(1 << 20);
+	ifstream input_file;
+	ofstream output_file;
+	if (input != "-") {
+		input_file.rdbuf()->pubsetbuf(input_buffer.data(), input_buffer.size());
+		input_file.open(input, ios::binary);
+		if (!input_file) {
+			cerr << "Cannot open the input file " << input << endl;
+			return 1;
+		}
+	}
+	if (!output.empty()) {
+		output_file.rdbuf()->pubsetbuf(output_buffer.data(), output_buffer.size());
+		output_file.open(output, ios::binary);
+		if (!output_file) {
+			cerr << "Cannot open the output file " << output << endl;
+			return 1;
+		}
+	}
+	istream& in = input == "-" ? cin : input_file;
+	ostream& out = output.empty() ? cout : output_file;
+	if (!make_book.empty())
+		return makeBook(in, batch.getInputFormat(), make_book);
+
+	BatchStats stats = batch.run(in, out);
+	cerr << stats.trades << " trades, " << stats.errors << " errors, " << stats.seconds << " s (" << stats.trades / max(stats.seconds, 1e-9) << " trades/s)" << endl;
+	dumpInstrumentation();
+	return out.good() ? 0 : 1;
+}
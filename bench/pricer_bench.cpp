@@ -0,0 +1,422 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "Option.h"
+#include "BlackScholesModel.h"
+#include "MultiAssetBSModel.h"
+#include "HestonModel.h"
+#include "MonteCarlo.h"
+#include "Numerics.h"
+#include "Revaluation.h"
+#include "Arena.h"
+
+using namespace std;
+
+/*
+	The Benchmarks of the pricer : closed forms, Monte-Carlo prices, random numbers and special functions throughput, and payoffs.
+	Run "pricer_bench --benchmark_out=results.json --benchmark_out_format=json" (or the "bench_json" target) to keep the results.
+*/
+
+const double RATE = 0.05;
+const double SPOT = 100;
+const double VOL = 0.3;
+
+vector<vector<double>> flat_corr(int d, double rho) {
+
+	/* Correlation matrix of size d with the same correlation rho between every pair of underlyings. */
+
+	vector<vector<double>> corr(d, vector<double>(d, rho));
+	for (int i = 0; i < d; i++)
+		corr[i][i] = 1;
+	return corr;
+}
+
+vector<vector<double>> sector_corr(int d, int nb_sectors) {
+
+	/* Correlation matrix of size d : 0.3 between the sectors, 0.6 inside the sectors. It has nb_sectors factors. */
+
+	vector<vector<double>> corr(d, vector<double>(d, 0.3));
+	for (int i = 0; i < d; i++)
+		for (int j = 0; j < d; j++)
+			corr[i][j] = i == j ? 1 : (i % nb_sectors == j % nb_sectors ? 0.6 : 0.3);
+	return corr;
+}
+
+/* Closed forms */
+
+static void BM_BlackVanilla(benchmark::State& state) {
+	BlackVanilla model(RATE, SPOT, VOL);
+	VanillaOption opt(105, 1, 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackVanilla);
+
+static void BM_BlackDigital(benchmark::State& state) {
+	BlackDigital model(RATE, SPOT, VOL);
+	DigitalOption opt(105, 1, 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackDigital);
+
+static void BM_BlackBarrier(benchmark::State& state) {
+	BlackBarrier model(RATE, SPOT, VOL);
+	BarrierOption opt(105, 145, 1, 1, "Up Out");
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackBarrier);
+
+static void BM_BlackAsian(benchmark::State& state) {
+	BlackAsian model(RATE, SPOT, VOL);
+	AsianOption opt(105, 1, 1, state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackAsian)->Arg(4)->Arg(12)->Arg(52)->Arg(252);
+
+static void BM_BlackBasket(benchmark::State& state) {
+	int d = state.range(0);
+	BlackBasket model(RATE, d, vector<double>(d, SPOT), vector<double>(d, VOL), flat_corr(d, 0.3));
+	BasketOption opt(100, 1, 1, d);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackBasket)->Arg(3)->Arg(10)->Arg(50)->Arg(500);
+
+static void BM_BlackBasketFactors(benchmark::State& state) {
+
+	/* Basket of 500 underlyings on 3 sectors, with a range(0)-factor correlation model. The counters are the errors against the full correlation. */
+
+	int d = 500;
+	vector<double> vols(d);
+	for (int i = 0; i < d; i++)
+		vols[i] = 0.2 + 0.01 * (i % 20);
+	BlackBasket full(RATE, d, vector<double>(d, SPOT), vols, sector_corr(d, 3));
+	BlackBasket model(RATE, d, vector<double>(d, SPOT), vols, sector_corr(d, 3));
+	model.FactorAlgo(state.range(0));
+	BasketOption opt(100, 1, 1, d);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+	state.counters["corr_max_error"] = model.getFactorMaxError();
+	state.counters["price_error"] = fabs(model.price(&opt) - full.price(&opt));
+}
+BENCHMARK(BM_BlackBasketFactors)->Arg(1)->Arg(2)->Arg(3);
+
+static void BM_BlackSpread(benchmark::State& state) {
+	BlackSpread model(RATE, { 105, 95 }, { 0.4, 0.3 }, flat_corr(2, 0.3));
+	SpreadOption opt(15, 1, 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_BlackSpread);
+
+static void BM_BlackSpreadQuadrature(benchmark::State& state) {
+	/*
+		Gauss-Hermite Spread prices of range(1) strikes from 5 to 25, with range(0) nodes. The counters are the largest errors
+		against the 128-node quadrature, of the quadrature and of Kirk's approximation.
+	*/
+	BlackSpread model(RATE, { 105, 95 }, { 0.4, 0.3 }, flat_corr(2, 0.3));
+	int n = state.range(1);
+	vector<double> K(n), prices(n), reference(n);
+	for (int j = 0; j < n; j++)
+		K[j] = n > 1 ? 5 + 20. * j / (n - 1) : 15;
+	for (auto _ : state) {
+		model.priceQuadrature(K.data(), prices.data(), n, 1, 1, state.range(0));
+		benchmark::DoNotOptimize(prices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+	model.priceQuadrature(K.data(), reference.data(), n, 1, 1, 128);
+	double error = 0, kirk_error = 0;
+	for (int j = 0; j < n; j++) {
+		error = max(error, fabs(prices[j] - reference[j]));
+		kirk_error = max(kirk_error, fabs(model.price(K[j], 1, 1) - reference[j]));
+	}
+	state.counters["error"] = error;
+	state.counters["kirk_error"] = kirk_error;
+}
+BENCHMARK(BM_BlackSpreadQuadrature)->Args({ 8, 1 })->Args({ 16, 1 })->Args({ 32, 1 })->Args({ 32, 64 });
+
+static void BM_HestonVanilla(benchmark::State& state) {
+	HestonModel model(RATE, SPOT, 0.09, 1.5, 0.09, 0.8, -0.7);
+	VanillaOption opt(105, 1, 1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(model.price(&opt));
+}
+BENCHMARK(BM_HestonVanilla)->Unit(benchmark::kMicrosecond);
+
+/* Monte-Carlo prices : range(0) is the number of paths */
+
+static void BM_MonteCarloVanilla(benchmark::State& state) {
+	BlackVanilla model(RATE, SPOT, VOL);
+	VanillaOption opt(105, 1, 1);
+	MonteCarlo mc(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloVanilla)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloVanillaSingle(benchmark::State& state) {
+	BlackVanilla model(RATE, SPOT, VOL);
+	VanillaOption opt(105, 1, 1);
+	MonteCarlo mc(state.range(0));
+	mc.setSinglePrecision(true);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloVanillaSingle)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloAsian(benchmark::State& state) {
+	BlackAsian model(RATE, SPOT, VOL);
+	AsianOption opt(105, 1, 1, 4);
+	MonteCarlo mc(state.range(0), 10);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloAsian)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloAsianSingle(benchmark::State& state) {
+	BlackAsian model(RATE, SPOT, VOL);
+	AsianOption opt(105, 1, 1, 4);
+	MonteCarlo mc(state.range(0), 10);
+	mc.setSinglePrecision(true);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloAsianSingle)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloBasket(benchmark::State& state) {
+	BlackBasket model(RATE, 3, { 100, 105, 95 }, { 0.35, 0.3, 0.4 }, { { 1, -0.6, 0.3 }, { -0.6, 1, -0.2 }, { 0.3, -0.2, 1 } });
+	BasketOption opt(100, 1, 1, 3);
+	MonteCarlo mc(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloBasket)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloBasketSingle(benchmark::State& state) {
+	BlackBasket model(RATE, 3, { 100, 105, 95 }, { 0.35, 0.3, 0.4 }, { { 1, -0.6, 0.3 }, { -0.6, 1, -0.2 }, { 0.3, -0.2, 1 } });
+	BasketOption opt(100, 1, 1, 3);
+	MonteCarlo mc(state.range(0));
+	mc.setSinglePrecision(true);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloBasketSingle)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloBasketFactors(benchmark::State& state) {
+
+	/* 1 000 paths of a Basket of 500 underlyings on 3 sectors, range(0) factors (0 for the full Cholesky correlation). */
+
+	int d = 500;
+	BlackBasket model(RATE, d, vector<double>(d, SPOT), vector<double>(d, VOL), sector_corr(d, 3));
+	model.FactorAlgo(state.range(0));
+	BasketOption opt(100, 1, 1, d);
+	MonteCarlo mc(1000);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * 1000);
+	state.counters["corr_max_error"] = model.getFactorMaxError();
+}
+BENCHMARK(BM_MonteCarloBasketFactors)->Arg(0)->Arg(1)->Arg(3)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloSpread(benchmark::State& state) {
+
+	/* The counter is the error of the Monte-Carlo price against the Gauss-Hermite quadrature. */
+
+	BlackSpread model(RATE, { 105, 95 }, { 0.4, 0.3 }, flat_corr(2, 0.3));
+	SpreadOption opt(15, 1, 1);
+	MonteCarlo mc(state.range(0));
+	double price = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(price = mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["error"] = fabs(price - model.priceQuadrature(&opt));
+}
+BENCHMARK(BM_MonteCarloSpread)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_MonteCarloHeston(benchmark::State& state) {
+	HestonModel model(RATE, SPOT, 0.09, 1.5, 0.09, 0.8, -0.7);
+	VanillaOption opt(105, 1, 1);
+	MonteCarlo mc(state.range(0), 4);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(mc.price(&model, &opt));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MonteCarloHeston)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/* Incremental revaluation : a book of 10 000 Vanillas on 100 market objects, range(0) market objects move on every tick */
+
+static void BM_RevaluationTick(benchmark::State& state) {
+	int nb_markets = 100;
+	Revaluation revaluation;
+	MarketObject market;
+	market.rate = RATE;
+	market.spot[0] = SPOT;
+	market.vol[0] = VOL;
+	for (int m = 0; m < nb_markets; m++)
+		revaluation.setMarket("market " + to_string(m), market);
+	for (int i = 0; i < 10000; i++) {
+		TradeRecord trade;
+		trade.id = i;
+		trade.strike = 80 + i % 41;
+		trade.maturity = 0.25 * (1 + i % 8);
+		revaluation.addTrade(trade, "market " + to_string(i % nb_markets));
+	}
+	revaluation.revalue();
+
+	int tick = 0;
+	for (auto _ : state) {
+		tick++;
+		market.spot[0] = SPOT + 0.01 * tick;
+		for (int m = 0; m < state.range(0); m++)
+			revaluation.setMarket("market " + to_string((tick + m) % nb_markets), market);
+		benchmark::DoNotOptimize(revaluation.revalue());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * 10000 / nb_markets);
+}
+BENCHMARK(BM_RevaluationTick)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+/* Random numbers and special functions throughput : items are numbers */
+
+static void BM_NormVariable(benchmark::State& state) {
+	for (auto _ : state)
+		benchmark::DoNotOptimize(norm_variable());
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NormVariable);
+
+vector<double> uniform_grid(int n, double low, double high) {
+	vector<double> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = low + (high - low) * (i + 0.5) / n;
+	return x;
+}
+
+typedef void (*ArrayKernel)(const double*, double*, int);
+
+static void BM_ArrayKernel(benchmark::State& state, ArrayKernel kernel, double low, double high) {
+	int n = 4096;
+	vector<double> x = uniform_grid(n, low, high);
+	vector<double> result(n);
+	for (auto _ : state) {
+		kernel(x.data(), result.data(), n);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_CAPTURE(BM_ArrayKernel, std_normal_cum, (ArrayKernel)std_normal_cum, -6., 6.);
+BENCHMARK_CAPTURE(BM_ArrayKernel, std_normal_cum_fast, (ArrayKernel)std_normal_cum_fast, -6., 6.);
+BENCHMARK_CAPTURE(BM_ArrayKernel, std_normal_pdf, (ArrayKernel)std_normal_pdf, -6., 6.);
+BENCHMARK_CAPTURE(BM_ArrayKernel, std_normal_inv, (ArrayKernel)std_normal_inv, 0., 1.);
+BENCHMARK_CAPTURE(BM_ArrayKernel, std_normal_inv_fast, (ArrayKernel)std_normal_inv_fast, 0., 1.);
+BENCHMARK_CAPTURE(BM_ArrayKernel, exp_fast, (ArrayKernel)exp_fast, -20., 20.);
+
+/* Payoffs */
+
+static void BM_VanillaPayoff(benchmark::State& state) {
+	VanillaOption opt(105, 1, 1);
+	vector<double> path = { 100, 110 };
+	for (auto _ : state)
+		benchmark::DoNotOptimize(opt.payoff(path));
+}
+BENCHMARK(BM_VanillaPayoff);
+
+static void BM_BarrierPayoff(benchmark::State& state) {
+	BarrierOption opt(105, 145, 1, 1, "Up Out", true);
+	vector<double> path = uniform_grid(state.range(0), 100, 120);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(opt.payoff(path));
+}
+BENCHMARK(BM_BarrierPayoff)->Arg(10)->Arg(100);
+
+static void BM_AsianPayoff(benchmark::State& state) {
+	AsianOption opt(105, 1, 1, state.range(0));
+	vector<double> path = uniform_grid(state.range(0), 90, 120);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(opt.payoff(path));
+}
+BENCHMARK(BM_AsianPayoff)->Arg(4)->Arg(52);
+
+static void BM_BasketPayoff(benchmark::State& state) {
+	BasketOption opt(100, 1, 1, state.range(0));
+	vector<double> path = uniform_grid(state.range(0), 90, 110);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(opt.payoff(path));
+}
+BENCHMARK(BM_BasketPayoff)->Arg(3)->Arg(50);
+
+/* Books of Options : building, reading the contract terms and freeing a mixed book of 1 000 000 Options. Items are Options */
+
+const int BOOK_SIZE = 1000000;
+
+template <typename Book>
+static void build_book(Book& book, int n) {
+
+	/* Mixed book of Vanillas, Digitals, Barriers and Asians : "book.add<T>(args)" builds one Option. */
+
+	for (int i = 0; i < n; i++) {
+		double K = 80 + i % 41;
+		int phi = i % 2 ? 1 : -1;
+		switch (i % 4) {
+		case 0: book.template add<VanillaOption>(K, 1, phi); break;
+		case 1: book.template add<DigitalOption>(K, 1, phi); break;
+		case 2:
+			if (i % 8 == 2)
+				book.template add<BarrierOption>(K, 145, 1, 1, "Up Out");
+			else
+				book.template add<BarrierOption>(K, 65, 1, -1, "Down In");
+			break;
+		case 3: book.template add<AsianOption>(K, 1, phi, 4); break;
+		}
+	}
+}
+
+struct HeapBook {
+	vector<Option*> options;
+	vector<void (*)(Option*)> deleters; // "Option" has no virtual destructor : each Option is deleted as its own flavor.
+	template <typename T, typename... Args> void add(Args&&... args) {
+		options.push_back(new T(std::forward<Args>(args)...));
+		deleters.push_back([](Option* option) { delete static_cast<T*>(option); });
+	};
+	~HeapBook() {
+		for (size_t i = 0; i < options.size(); i++)
+			deleters[i](options[i]);
+	};
+};
+
+struct ArenaBook {
+	Arena arena;
+	vector<Option*> options;
+	template <typename T, typename... Args> void add(Args&&... args) { options.push_back(arena.create<T>(std::forward<Args>(args)...)); };
+};
+
+struct ValueBook {
+	vector<OptionValue> options;
+	template <typename T, typename... Args> void add(Args&&... args) { options.emplace_back().emplace<T>(std::forward<Args>(args)...); };
+};
+
+template <typename Book>
+static void BM_OptionBook(benchmark::State& state) {
+	for (auto _ : state) {
+		Book book;
+		book.options.reserve(BOOK_SIZE);
+		build_book(book, BOOK_SIZE);
+		double sum = 0;
+		for (auto& option : book.options)
+			sum += option->getPhi() * option->getStrike();
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * BOOK_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_OptionBook, HeapBook)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OptionBook, ArenaBook)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OptionBook, ValueBook)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include "MonteCarlo.h"
+#include "Instrumentation.h"
+
+using namespace std;
+
+/*
+	The allocation count check of the instrumentation, run by CTest : the heap allocations counted by the Monte-Carlo engine
+	(PRICER_COUNT_ALLOCATIONS) must be the real ones, counted here by a replaced operator new.
+	Every pricing is run twice on the first cases : the first call registers the counters of the thread and grows its trace, which
+	the engine does not count, and the second one is compared. The last cases are measured on their first call, with a new Schedule
+	and buffers that grow.
+*/
+
+static thread_local bool counting = false;
+static thread_local uint64_t real_allocations = 0;
+
+void* operator new(size_t size) {
+	if (counting)
+		real_allocations++;
+	void* p = malloc(size > 0 ? size : 1);
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+int nb_failures = 0;
+
+template <typename Pricing> void check(const char* name, Pricing pricing, bool warm_up = true) {
+
+	/* Compares the engine count of one pricing call with the real allocations. */
+
+	if (warm_up)
+		pricing();
+	Instrumentation::reset();
+	uint64_t counted = Instrumentation::getAllocations();
+	real_allocations = 0;
+	counting = true;
+	pricing();
+	counting = false;
+	counted = Instrumentation::getAllocations() - counted;
+	bool ok = counted == real_allocations;
+	printf("%-32s counted %8llu  real %8llu  %s\n", name, (unsigned long long)counted, (unsigned long long)real_allocations, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+int main() {
+	BlackVanilla vanilla(0.05, 100, 0.3);
+	BlackAsian asian(0.05, 100, 0.3);
+	VanillaOption call(105, 1, 1);
+	AsianOption call_asian(105, 1, 1, 4);
+	BarrierOption up_out(105, 140, 1, 1, "Up Out", true);
+	BlackBasket basket(0.05, 3, { 100, 105, 95 }, { 0.35, 0.3, 0.4 }, { { 1, -0.6, 0.3 }, { -0.6, 1, -0.2 }, { 0.3, -0.2, 1 } });
+	BlackBasket factor_basket = basket;
+	factor_basket.FactorAlgo(1);
+	BasketOption call_basket(100, 1, 1, 3);
+	BlackSpread spread(0.05, { 100, 95 }, { 0.3, 0.25 }, { { 1, 0.5 }, { 0.5, 1 } });
+	SpreadOption call_spread(5, 1, 1);
+	HestonModel heston(0.05, 100, 0.04, 1.5, 0.04, 0.5, -0.7);
+
+	MonteCarlo mc(1000, 10), mc_single(1000, 10);
+	mc_single.setSinglePrecision(true);
+
+	check("BS Vanilla", [&] { mc.price(&vanilla, &call); });
+	check("BS Asian", [&] { mc.price(&asian, &call_asian); });
+	check("BS monitored Barrier", [&] { mc.price(&vanilla, &up_out); });
+	check("BS Vanilla single", [&] { mc_single.price(&vanilla, &call); });
+	check("BS Asian single", [&] { mc_single.price(&asian, &call_asian); });
+	check("Basket", [&] { mc.price(&basket, &call_basket); });
+	check("Basket factor model", [&] { mc.price(&factor_basket, &call_basket); });
+	check("Basket single", [&] { mc_single.price(&basket, &call_basket); });
+	check("Spread", [&] { mc.price(&spread, &call_spread); });
+	check("Heston Vanilla", [&] { mc.price(&heston, &call); });
+	check("Heston Asian", [&] { mc.price(&heston, &call_asian, false); });
+	check("MLMC Vanilla", [&] { mc.priceMLMC(&vanilla, &call, 0.05); });
+	check("MLMC Asian", [&] { mc.priceMLMC(&asian, &call_asian, 0.05); });
+	check("MLMC monitored Barrier", [&] { mc.priceMLMC(&vanilla, &up_out, 0.05); });
+
+	// First calls : a Schedule missing from the cache, and buffers that grow
+	MonteCarlo mc_long(200, 300), mc_long_single(200, 300);
+	mc_long_single.setSinglePrecision(true);
+	check("BS Asian, new grid", [&] { mc_long.price(&asian, &call_asian); }, false);
+	check("BS Asian single, new grid", [&] { mc_long_single.price(&asian, &call_asian); }, false);
+	check("Heston Asian, new grid", [&] { mc_long.price(&heston, &call_asian); }, false);
+	vector<vector<double>> large_corr(40, vector<double>(40, 0.5));
+	for (int i = 0; i < 40; i++)
+		large_corr[i][i] = 1;
+	BlackBasket large_basket(0.05, 40, vector<double>(40, 100), vector<double>(40, 0.3), large_corr);
+	BasketOption call_large_basket(100, 1, 1, 40);
+	check("Basket single, larger basket", [&] { mc_single.price(&large_basket, &call_large_basket); }, false);
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include "Arena.h"
+#include "MonteCarlo.h"
+
+using namespace std;
+
+/*
+	The checks of the Option and model ownership, run by CTest.
+	Arena : the alignment of the allocations, the blocks it allocates, the large objects kept out of the regular blocks, the destructors
+	run in reverse order on "reset" and on destruction, and the first block kept by "reset". The Options and models built in an Arena
+	must price as the ones built on the stack.
+	OptionValue : every flavor held inline, copied through the growth of a vector and by assignment, and replaced by "emplace" : the
+	payoffs of the held Options must be the payoffs of the Options built directly.
+*/
+
+int nb_failures = 0;
+
+void check(const char* name, bool ok) {
+
+	/* Prints the check and records a failure. */
+
+	printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+vector<int> destroyed; // Ids of the destroyed "Tracked" objects, in order.
+
+struct Tracked {
+	int id;
+	vector<double> data; // Not trivially destructible.
+	Tracked(int i) : id(i), data(4, i) {};
+	~Tracked() { destroyed.push_back(id); };
+};
+
+int main() {
+	// Alignment and blocks
+	Arena arena(1024);
+	bool aligned = true;
+	for (size_t alignment : { 1, 2, 8, 16, 64 })
+		for (size_t size : { 1, 3, 24, 100 })
+			aligned = aligned && (uintptr_t)arena.allocate(size, alignment) % alignment == 0;
+	check("allocations aligned", aligned);
+	arena.reset();
+	for (int i = 0; i < 100; i++)
+		arena.allocate(64, 8);
+	check("100 objects of 64 bytes in blocks of 1024", arena.getUsed() == 6400 && arena.getNbBlocks() == 7);
+	char* small = (char*)arena.allocate(8, 8);
+	arena.allocate(4096, 8);
+	char* next = (char*)arena.allocate(8, 8);
+	check("large object in a block of its own", next == small + 8 && arena.getNbBlocks() == 8);
+	arena.reset();
+	check("reset keeps the first block", arena.getUsed() == 0 && arena.getNbBlocks() == 1);
+
+	// Destructors
+	{
+		Arena tracked_arena(256);
+		for (int i = 0; i < 3; i++)
+			tracked_arena.create<Tracked>(i);
+		tracked_arena.reset();
+		check("reset destroys in reverse order", destroyed == vector<int>({ 2, 1, 0 }));
+		destroyed.clear();
+		tracked_arena.create<Tracked>(3);
+		tracked_arena.create<VanillaOption>(105, 1, 1);
+		tracked_arena.create<Tracked>(4);
+	}
+	check("destruction destroys the remaining objects", destroyed == vector<int>({ 4, 3 }));
+
+	// Options and models of a book in an Arena
+	vector<vector<double>> corr = { { 1, 0.5, 0.2 }, { 0.5, 1, 0.3 }, { 0.2, 0.3, 1 } };
+	BlackVanilla vanilla(0.05, 100, 0.3);
+	BlackBasket basket(0.05, 3, { 100, 95, 105 }, { 0.3, 0.25, 0.35 }, corr);
+	VanillaOption call(105, 1, 1);
+	BasketOption call_basket(100, 1, 1, 3);
+	bool same_prices = true;
+	for (int i = 0; i < 50; i++) {
+		BlackVanilla* arena_vanilla = arena.create<BlackVanilla>(0.05, 100, 0.3);
+		VanillaOption* arena_call = arena.create<VanillaOption>(105, 1, 1);
+		BlackBasket* arena_basket = arena.create<BlackBasket>(0.05, 3, vector<double>({ 100, 95, 105 }), vector<double>({ 0.3, 0.25, 0.35 }), corr);
+		BasketOption* arena_call_basket = arena.create<BasketOption>(100, 1, 1, 3);
+		same_prices = same_prices && arena_vanilla->price(arena_call) == vanilla.price(&call) && arena_basket->price(arena_call_basket) == basket.price(&call_basket);
+	}
+	check("Arena Options and models price as on the stack", same_prices);
+	arena.reset();
+
+	// OptionValue
+	OptionValue empty;
+	OptionValue empty_copy = empty;
+	check("empty OptionValue", empty.empty() && empty_copy.empty() && empty.get() == nullptr);
+
+	VanillaOption vanilla_call(105, 1, 1);
+	DigitalOption digital_put(95, 1, -1);
+	BarrierOption up_out(105, 130, 1, 1, "Up Out");
+	AsianOption asian_call(100, 1, 1, 4);
+	BasketOption basket_call(100, 1, 1, 3);
+	SpreadOption spread_call(5, 1, 1);
+	vector<Option*> options = { &vanilla_call, &digital_put, &up_out, &asian_call, &basket_call, &spread_call };
+	vector<double> path = { 98, 104, 112, 108 };
+	vector<double> spots = { 120, 90, 101 };
+
+	vector<OptionValue> book; // Grows from empty : every reallocation copies the held Options
+	for (int i = 0; i < 600; i++) {
+		switch (i % 6) {
+		case 0: book.push_back(OptionValue::make<VanillaOption>(105, 1, 1)); break;
+		case 1: book.push_back(OptionValue::make<DigitalOption>(95, 1, -1)); break;
+		case 2: book.push_back(OptionValue::make<BarrierOption>(105, 130, 1, 1, "Up Out")); break;
+		case 3: book.push_back(OptionValue::make<AsianOption>(100, 1, 1, 4)); break;
+		case 4: book.emplace_back().emplace<BasketOption>(100, 1, 1, 3); break;
+		default: book.emplace_back().emplace<SpreadOption>(5, 1, 1);
+		}
+	}
+	auto same_option = [&](OptionValue& value, Option* reference) {
+		const vector<double>& input = reference == &basket_call || reference == &spread_call ? spots : path;
+		return value->getType() == reference->getType() && value->getStrike() == reference->getStrike() && value->payoff(input) == reference->payoff(input);
+	};
+	bool same_payoffs = true;
+	for (int i = 0; i < 600; i++)
+		same_payoffs = same_payoffs && same_option(book[i], options[i % 6]);
+	check("OptionValue book : types and payoffs", same_payoffs);
+
+	OptionValue assigned = book[2];
+	assigned = book[3];
+	OptionValue& self = assigned;
+	assigned = self;
+	check("assignment, self-assignment", same_option(assigned, &asian_call));
+	assigned.emplace<SpreadOption>(5, 1, 1);
+	check("emplace replaces the flavor", same_option(assigned, &spread_call) && same_option(book[3], &asian_call));
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include "BatchPricer.h"
+
+using namespace std;
+
+/*
+	The checks of the batch pricer, run by CTest : a CSV batch mixing priced rows with every kind of error row, on several
+	threads and small chunks. The error rows must get their status and keep the run going, and the results must come out
+	one line per trade, in input order. The rows that an Option or a model constructor would reject (a Barrier Call below its
+	strike, a Heston model without volatility of the variance) must not end the process.
+	The same batch is then converted to binary "TradeRecord"s, and priced again from binary to binary "ResultRecord"s.
+*/
+
+const int NB_ROWS = 600;
+const int NB_KINDS = 6;
+int nb_failures = 0;
+
+void check(const char* name, bool ok) {
+
+	/* Prints the check and records a failure. */
+
+	printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+string row(int i) {
+
+	/* Row i of the batch : its kind is i % NB_KINDS, see "expected_status". */
+
+	char line[256];
+	switch (i % NB_KINDS) {
+	case 0:
+		snprintf(line, sizeof(line), "%d,Vanilla,Call,%d,1,,,,,,Black,Analytical,0.05,100,0.3", i, 80 + i % 40);
+		break;
+	case 1:
+		snprintf(line, sizeof(line), "%d,Vanila,Call,100,1", i);
+		break;
+	case 2:
+		snprintf(line, sizeof(line), "%d,Barrier,Call,105,1,100,Up Out,,,,Black,Analytical,0.05,100,0.3", i);
+		break;
+	case 3:
+		snprintf(line, sizeof(line), "%d,Vanilla,Call,100,1,,,,,,Heston,Analytical,0.05,100,,,0.04,1.5,0.04,0,-0.7", i);
+		break;
+	case 4:
+		snprintf(line, sizeof(line), "%d,Vanilla,Call,100,1,,,,,,Heston,MLMC,0.05,100,,,0.04,1.5,0.04,0.5,-0.7", i);
+		break;
+	default:
+		snprintf(line, sizeof(line), "%d,Vanilla,Put,100,1,,,,,,Black,MC,0.05,100,0.3,,,,,,,1000,1", i);
+	}
+	return line;
+}
+
+TradeStatus expected_status(int i) {
+	const TradeStatus statuses[NB_KINDS] = { TRADE_OK, TRADE_PARSE_ERROR, TRADE_INVALID_CONTRACT, TRADE_INVALID_MODEL, TRADE_UNSUPPORTED, TRADE_OK };
+	return statuses[i % NB_KINDS];
+}
+
+bool expected_price(int i, double price) {
+
+	/* The analytical rows are the BS prices, the Monte-Carlo Puts (1000 paths, standard error 0.24) stay within 6 standard errors. */
+
+	BlackVanilla model(0.05, 100, 0.3);
+	if (i % NB_KINDS == 0)
+		return fabs(price - model.price(80 + i % 40, 1, 1)) <= 1e-10 * price;
+	return fabs(price - model.price(100, 1, -1)) <= 1.5;
+}
+
+int main() {
+	string csv = string(TRADE_CSV_HEADER) + "\n";
+	for (int i = 0; i < NB_ROWS; i++) {
+		if (i % 50 == 0)
+			csv += "# Comment line\n\n";
+		csv += row(i) + "\n";
+	}
+	int nb_errors = 0;
+	for (int i = 0; i < NB_ROWS; i++)
+		nb_errors += expected_status(i) != TRADE_OK;
+
+	// CSV to CSV
+	BatchPricer pricer(4, 16);
+	istringstream csv_in(csv);
+	ostringstream csv_out;
+	BatchStats stats = pricer.run(csv_in, csv_out);
+	check("CSV trades and errors counted", stats.trades == NB_ROWS && stats.errors == (uint64_t)nb_errors);
+
+	istringstream results(csv_out.str());
+	string line;
+	getline(results, line);
+	check("CSV header", line == RESULT_CSV_HEADER);
+	int n = 0;
+	bool in_order = true, statuses = true, prices = true;
+	for (; getline(results, line); n++) {
+		size_t first = line.find(','), second = line.find(',', first + 1);
+		int id = atoi(line.substr(0, first).c_str());
+		string price = line.substr(first + 1, second - first - 1);
+		string status = line.substr(second + 1);
+		in_order = in_order && id == n;
+		statuses = statuses && status == tradeStatusName(expected_status(n));
+		if (expected_status(n) == TRADE_OK)
+			prices = prices && expected_price(n, atof(price.c_str()));
+		else
+			prices = prices && price.empty();
+	}
+	check("one CSV result per trade, in input order", n == NB_ROWS && in_order);
+	check("CSV statuses of the error rows", statuses);
+	check("CSV prices", prices);
+
+	// CSV to binary trades, then binary trades to binary results
+	BatchPricer converter(4, 16);
+	converter.setConvertOnly(true);
+	istringstream convert_in(csv);
+	ostringstream binary_trades;
+	stats = converter.run(convert_in, binary_trades);
+	int nb_valid = NB_ROWS - nb_errors;
+	check("conversion keeps the valid trades", stats.errors == (uint64_t)nb_errors && binary_trades.str().size() == nb_valid * sizeof(TradeRecord));
+
+	BatchPricer binary_pricer(4, 16);
+	binary_pricer.setInputFormat(FORMAT_BINARY);
+	binary_pricer.setOutputFormat(FORMAT_BINARY);
+	istringstream binary_in(binary_trades.str());
+	ostringstream binary_out;
+	stats = binary_pricer.run(binary_in, binary_out);
+	string output = binary_out.str();
+	vector<ResultRecord> binary_results(output.size() / sizeof(ResultRecord));
+	if (!binary_results.empty())
+		memcpy(binary_results.data(), output.data(), output.size());
+	bool binary_ok = stats.trades == (uint64_t)nb_valid && stats.errors == 0 && output.size() == nb_valid * sizeof(ResultRecord);
+	int k = 0;
+	for (int i = 0; binary_ok && i < NB_ROWS; i++) {
+		if (expected_status(i) != TRADE_OK)
+			continue;
+		const ResultRecord& result = binary_results[k++];
+		binary_ok = result.id == (uint64_t)i && result.status == TRADE_OK && expected_price(i, result.price);
+	}
+	check("binary results of the converted trades", binary_ok);
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "MonteCarlo.h"
+
+using namespace std;
+
+/*
+	The checks of the factor correlation model of the Baskets, run by CTest.
+	On correlation matrices with an exact k-factor structure (a constant correlation, two sectors, random loadings), "FactorAlgo(k)" must
+	find the correlations back, and the errors it reports must be the errors of its loadings. A single factor on the two sectors cannot.
+	The factor model Basket price must be the full Cholesky price on these matrices : with the series of the second moment (1 factor) and
+	with its exact sum (3 factors, where the series would cost more). The factor model Monte-Carlo price, the mean of NB_BATCHES prices,
+	must stay within 5 standard errors of the full Cholesky one. "FactorAlgo(0)" restores the full Cholesky correlation.
+*/
+
+const int NB_BATCHES = 20;
+const int D = 40;
+int nb_failures = 0;
+
+void check(const char* name, double error, double bound) {
+
+	/* Prints the error against its bound and records a failure when it is larger. */
+
+	bool ok = error <= bound;
+	printf("%-48s error %.3g  bound %.2g  %s\n", name, error, bound, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+vector<vector<double>> factor_corr(const vector<vector<double>>& loadings) {
+
+	/* Correlation matrix L L' with a unit diagonal. */
+
+	int n = (int)loadings.size();
+	vector<vector<double>> corr(n, vector<double>(n, 1));
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			if (i != j) {
+				corr[i][j] = 0;
+				for (size_t f = 0; f < loadings[i].size(); f++)
+					corr[i][j] += loadings[i][f] * loadings[j][f];
+			}
+	return corr;
+}
+
+double loadings_error(BlackBasket& basket) {
+
+	/* Largest difference between the reported maximum error and the errors of the loadings. */
+
+	vector<vector<double>> L = basket.getFactorLoadings();
+	vector<vector<double>> corr = basket.getCorr();
+	double max_error = 0;
+	for (int i = 0; i < D; i++)
+		for (int j = i + 1; j < D; j++) {
+			double c = 0;
+			for (size_t f = 0; f < L[i].size(); f++)
+				c += L[i][f] * L[j][f];
+			max_error = max(max_error, fabs(corr[i][j] - c));
+		}
+	return fabs(max_error - basket.getFactorMaxError());
+}
+
+void monte_carlo(MonteCarlo& mc, BlackBasket* model, Option* opt, double& mean, double& se) {
+
+	/* Mean and standard error of NB_BATCHES Monte-Carlo prices. */
+
+	double sum = 0, sum2 = 0;
+	for (int b = 0; b < NB_BATCHES; b++) {
+		double p = mc.price(model, opt);
+		sum += p;
+		sum2 += p * p;
+	}
+	mean = sum / NB_BATCHES;
+	se = sqrt(max(sum2 / NB_BATCHES - mean * mean, 0.) / (NB_BATCHES - 1));
+}
+
+int main() {
+	vector<double> spots(D), vols(D);
+	for (int i = 0; i < D; i++) {
+		spots[i] = 80 + i;
+		vols[i] = 0.2 + 0.005 * i;
+	}
+
+	// Constant correlation : one factor of loadings sqrt(0.5)
+	BlackBasket constant(0.05, D, spots, vols, factor_corr(vector<vector<double>>(D, vector<double>(1, sqrt(0.5)))));
+	constant.FactorAlgo(1);
+	double loading_error = 0;
+	for (const vector<double>& loadings : constant.getFactorLoadings())
+		loading_error = max(loading_error, fabs(fabs(loadings[0]) - sqrt(0.5)));
+	check("constant correlation, 1 factor", constant.getFactorMaxError(), 1e-8);
+	check("constant correlation loadings", loading_error, 1e-8);
+
+	// Two sectors : 0.6 within a sector, 0.2 across
+	vector<vector<double>> sector_corr(D, vector<double>(D, 0.2));
+	for (int i = 0; i < D; i++)
+		for (int j = 0; j < D; j++)
+			if (i == j)
+				sector_corr[i][j] = 1;
+			else if ((i < D / 2) == (j < D / 2))
+				sector_corr[i][j] = 0.6;
+	BlackBasket sectors(0.05, D, spots, vols, sector_corr);
+	sectors.FactorAlgo(1);
+	double one_factor_error = sectors.getFactorRMSError();
+	sectors.FactorAlgo(2);
+	check("two sectors, 2 factors", sectors.getFactorMaxError(), 1e-6);
+	check("two sectors, 2 factors against 1", sectors.getFactorRMSError() / one_factor_error, 1e-4);
+	check("two sectors, getNbNormals", fabs(sectors.getNbNormals() - (D + 2.)), 0);
+
+	// Random positive loadings of 3 factors : "makeCorrDefPos" floors the correlations at -1 / (d - 1)
+	vector<vector<double>> random_loadings(D, vector<double>(3));
+	unsigned int seed = 2024;
+	for (int i = 0; i < D; i++)
+		for (int f = 0; f < 3; f++) {
+			seed = seed * 1664525 + 1013904223;
+			random_loadings[i][f] = 0.1 + 0.45 * (seed / 4294967296.0);
+		}
+	vector<vector<double>> random_corr = factor_corr(random_loadings);
+	BlackBasket random(0.05, D, spots, vols, random_corr);
+	random.FactorAlgo(3);
+	check("random 3-factor correlation, 3 factors", random.getFactorMaxError(), 1e-6);
+	check("reported error = error of the loadings", loadings_error(random), 1e-15);
+
+	// Basket prices : the factor model against the full Cholesky correlation
+	BasketOption call(100, 1, 1, D);
+	BlackBasket full_constant(0.05, D, spots, vols, constant.getCorr()), full(0.05, D, spots, vols, random_corr);
+	double full_price = full.price(&call);
+	check("factor price, series of the second moment", fabs(constant.price(&call) / full_constant.price(&call) - 1), 1e-9);
+	check("factor price, exact second moment", fabs(random.price(&call) / full_price - 1), 1e-9);
+
+	// Factor model Monte-Carlo against the full Cholesky Monte-Carlo : the moment matching price is an approximation
+	MonteCarlo mc(5000, 1);
+	double mean, se, full_mean, full_se;
+	monte_carlo(mc, &random, &call, mean, se);
+	monte_carlo(mc, &full, &call, full_mean, full_se);
+	check("factor Monte-Carlo against the Cholesky one", fabs(mean - full_mean), 5 * sqrt(se * se + full_se * full_se));
+
+	// Back to the full correlation
+	random.FactorAlgo(0);
+	bool restored = random.getNbFactors() == 0 && random.getFactorLoadings().empty() && random.getNbNormals() == D;
+	check("FactorAlgo(0) restores the Cholesky model", restored ? fabs(random.price(&call) - full_price) : 1, 0);
+
+	return nb_failures == 0 ? 0 : 1;
+}
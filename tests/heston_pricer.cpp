@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "MonteCarlo.h"
+
+using namespace std;
+
+/*
+	The checks of the Heston pricers, run by CTest.
+	The semi-analytic price must meet the Call-Put parity, and the Black-Scholes price when the volatility of the variance vanishes.
+	The QE Monte-Carlo prices, without control variate, are the mean of NB_BATCHES prices and must stay within 5 standard errors of the
+	semi-analytic price.
+*/
+
+const int NB_BATCHES = 20;
+int nb_failures = 0;
+
+void check(const char* name, double value, double reference, double tolerance) {
+
+	/* Prints the value against its reference and records a failure when they differ by more than "tolerance". */
+
+	bool ok = fabs(value - reference) <= tolerance;
+	printf("%-40s value %.10g  reference %.10g  tolerance %.2g  %s\n", name, value, reference, tolerance, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+void check_monte_carlo(const char* name, MonteCarlo& mc, HestonModel* model, Option* opt) {
+
+	/* Mean and standard error of NB_BATCHES Monte-Carlo prices, against the semi-analytic price. */
+
+	double sum = 0, sum2 = 0;
+	for (int b = 0; b < NB_BATCHES; b++) {
+		double p = mc.price(model, opt, false);
+		sum += p;
+		sum2 += p * p;
+	}
+	double mean = sum / NB_BATCHES;
+	double se = sqrt(max(sum2 / NB_BATCHES - mean * mean, 0.) / (NB_BATCHES - 1));
+	check(name, mean, model->price(opt), 5 * se);
+}
+
+int main() {
+	double r = 0.05, S = 100, T = 1;
+	HestonModel heston(r, S, 0.04, 1.5, 0.04, 0.5, -0.7);
+
+	// Call-Put parity of the semi-analytic prices, on a short and a long maturity
+	for (double maturity : { 0.1, 10. }) {
+		char name[64];
+		snprintf(name, sizeof(name), "Call-Put parity, T = %g", maturity);
+		check(name, heston.price(110, maturity, 1) - heston.price(110, maturity, -1), S - 110 * exp(-r * maturity), 1e-10);
+	}
+
+	// Constant variance : xi -> 0 with v0 = theta and rho = 0 is the BS model of volatility sqrt(v0), up to O(xi^2)
+	HestonModel flat(r, S, 0.09, 1.5, 0.09, 1e-4, 0);
+	BlackVanilla black(r, S, 0.3);
+	for (double K : { 80., 100., 120. }) {
+		char name[64];
+		snprintf(name, sizeof(name), "BS limit, K = %g", K);
+		check(name, flat.price(K, T, 1), black.price(K, T, 1), 1e-6);
+	}
+
+	MonteCarlo mc(5000, 10);
+	VanillaOption call_itm(80, T, 1), call_atm(100, T, 1), call_otm(120, T, 1), put_atm(100, T, -1);
+	check_monte_carlo("QE MC, Call K = 80", mc, &heston, &call_itm);
+	check_monte_carlo("QE MC, Call K = 100", mc, &heston, &call_atm);
+	check_monte_carlo("QE MC, Call K = 120", mc, &heston, &call_otm);
+	check_monte_carlo("QE MC, Put K = 100", mc, &heston, &put_atm);
+
+	return nb_failures == 0 ? 0 : 1;
+}
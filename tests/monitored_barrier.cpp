@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "MonteCarlo.h"
+#include "Numerics.h"
+
+using namespace std;
+
+/*
+	The checks of the monitored Barriers, run by CTest : every engine prices the continuously monitored Barrier, whatever its time steps.
+	The reference is the closed form of the continuously monitored Up Out Call (Reiner and Rubinstein, 1991), and the Up In is its Vanilla parity.
+	The Monte-Carlo prices are the mean of NB_BATCHES prices, and must stay within 5 standard errors of the reference,
+	the Multilevel prices within 4 times their target RMSE.
+	The coupled fine and coarse paths of the MLMC levels are checked as well : under the exact log-normal step, the coarse path of the
+	Asians and of the Vanillas is the fine path on fewer dates, so their payoffs must match.
+*/
+
+const int NB_BATCHES = 20;
+int nb_failures = 0;
+
+void check(const char* name, double value, double reference, double tolerance) {
+
+	/* Prints the value against its reference and records a failure when they differ by more than "tolerance". */
+
+	bool ok = fabs(value - reference) <= tolerance;
+	printf("%-40s value %.6g  reference %.6g  tolerance %.2g  %s\n", name, value, reference, tolerance, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+double up_out_call(double S, double K, double B, double T, double r, double sigma) {
+
+	/* Continuously monitored Up Out Call, for K < B (Hull, Options, Futures and Other Derivatives, without dividends). */
+
+	double sqrt_T = sigma * sqrt(T);
+	double lambda = (r + sigma * sigma / 2) / (sigma * sigma);
+	double df = exp(-r * T);
+	double d1 = (log(S / K) + (r + sigma * sigma / 2) * T) / sqrt_T;
+	double call = S * std_normal_cum(d1) - K * df * std_normal_cum(d1 - sqrt_T);
+	double x1 = log(S / B) / sqrt_T + lambda * sqrt_T;
+	double y = log(B * B / (S * K)) / sqrt_T + lambda * sqrt_T;
+	double y1 = log(B / S) / sqrt_T + lambda * sqrt_T;
+	double up_in = S * std_normal_cum(x1) - K * df * std_normal_cum(x1 - sqrt_T)
+		- S * pow(B / S, 2 * lambda) * (std_normal_cum(-y) - std_normal_cum(-y1))
+		+ K * df * pow(B / S, 2 * lambda - 2) * (std_normal_cum(-y + sqrt_T) - std_normal_cum(-y1 + sqrt_T));
+	return call - up_in;
+}
+
+template <typename Model> void check_monte_carlo(const char* name, MonteCarlo& mc, Model* model, Option* opt, double reference) {
+
+	/* Mean and standard error of NB_BATCHES Monte-Carlo prices, against the reference. */
+
+	double sum = 0, sum2 = 0;
+	for (int b = 0; b < NB_BATCHES; b++) {
+		double p = mc.price(model, opt);
+		sum += p;
+		sum2 += p * p;
+	}
+	double mean = sum / NB_BATCHES;
+	double se = sqrt(max(sum2 / NB_BATCHES - mean * mean, 0.) / (NB_BATCHES - 1));
+	check(name, mean, reference, 5 * se);
+}
+
+void check_coupling(const char* name, BlackScholesModel* model, Option* opt, int level) {
+
+	/* Largest difference between the fine and the coarse payoffs of the level. */
+
+	MonteCarlo mc(1, 10);
+	shared_ptr<const Schedule> schedule = mc.getSchedule(opt);
+	double error = 0;
+	for (int i = 0; i < 2000; i++) {
+		double fine_payoff, coarse_payoff;
+		mc.getMLMCSample(model, opt, level, *schedule, fine_payoff, coarse_payoff);
+		error = max(error, fabs(fine_payoff - coarse_payoff));
+	}
+	check(name, error, 0, 1e-9);
+}
+
+int main() {
+	double S = 100, K = 105, B = 140, T = 1, r = 0.05, sigma = 0.3;
+	BlackBarrier model(r, S, sigma);
+	BarrierOption up_out(K, B, T, 1, "Up Out", true);
+	BarrierOption up_in(K, B, T, 1, "Up In", true);
+	VanillaOption call(K, T, 1);
+	double reference_out = up_out_call(S, K, B, T, r, sigma);
+	double reference_in = BlackVanilla(r, S, sigma).price(&call) - reference_out;
+
+	MonteCarlo mc_10(20000, 10), mc_50(20000, 50), mc_single(20000, 10);
+	mc_single.setSinglePrecision(true);
+	check_monte_carlo("Up Out, MC on 10 steps", mc_10, &model, &up_out, reference_out);
+	check_monte_carlo("Up Out, MC on 50 steps", mc_50, &model, &up_out, reference_out);
+	check_monte_carlo("Up Out, single precision MC", mc_single, &model, &up_out, reference_out);
+	check_monte_carlo("Up In, MC on 10 steps", mc_10, &model, &up_in, reference_in);
+	check("Up Out, MLMC", mc_10.priceMLMC(&model, &up_out, 0.05), reference_out, 4 * 0.05);
+	check("Up In, MLMC", mc_10.priceMLMC(&model, &up_in, 0.05), reference_in, 4 * 0.05);
+
+	// Heston with a negligible volatility of the variance : the BS Barrier of volatility sqrt(v0)
+	HestonModel heston(r, S, sigma * sigma, 1, sigma * sigma, 1e-4, 0);
+	MonteCarlo mc_heston(10000, 10);
+	check_monte_carlo("Up Out, Heston MC on 10 steps", mc_heston, &heston, &up_out, reference_out);
+
+	BlackAsian asian(r, S, sigma);
+	AsianOption call_asian(K, T, 1, 4);
+	check_coupling("MLMC coupling, Asian level 1", &asian, &call_asian, 1);
+	check_coupling("MLMC coupling, Asian level 3", &asian, &call_asian, 3);
+	check_coupling("MLMC coupling, Vanilla level 2", &model, &call, 2);
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Numerics.h"
+
+using namespace std;
+
+/*
+	The accuracy checks of the "Numerics" functions, run by CTest : every function is compared against a reference on a grid of inputs,
+	and the largest error must stay below the bound documented in Numerics.h.
+	References : erfc for the CDFs, the round trip through the CDF for the inverse CDFs, exp for exp_fast, and the moments of the weight for Gauss-Hermite.
+	The bivariate CDF is compared against BVN_REFERENCE, computed with 40 digits (mpmath) as the integral of pdf(t) N((y - rho t) / sqrt(1 - rho^2))
+	up to x, and checked against Plackett's integral over asin(rho) : |rho| up to 0.999999, and both sides of the switch of BVND at |rho| = 0.925.
+*/
+
+int nb_failures = 0;
+
+void check(const char* name, double error, double bound) {
+
+	/* Prints the largest error of the function and records a failure when it exceeds its bound. */
+
+	bool ok = error <= bound;
+	printf("%-24s max error %.3e  bound %.3e  %s\n", name, error, bound, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+double reference_cum(double x) {
+	return 0.5 * erfc(-x / sqrt(2.));
+}
+
+const double BVN_POINTS[6][2] = { { -2, -1.5 }, { 0, 0 }, { 0.5, 0.49 }, { 1.2, -0.8 }, { -0.7, 1.9 }, { 2.5, 3 } };
+
+struct BivariateReference {
+	double rho;
+	double values[6]; // P(X < x, Y < y) at the BVN_POINTS (x, y).
+};
+
+const BivariateReference BVN_REFERENCE[] = {
+	{ -0.999999, { 0, 0.00022507909779587066, 0.37939551185662256, 0.096785728361688418, 0.21324709240707122, 0.99244043664259377 } },
+	{ -0.99, { 3.5294192700659516e-138, 0.022526706822206052, 0.37939551185663249, 0.096809393537372592, 0.21324709240707122, 0.99244043664259377 } },
+	{ -0.9, { 5.5122529497592125e-17, 0.071783146564353135, 0.38025146856022771, 0.10776198585182384, 0.21333155394578198, 0.99244043664259377 } },
+	{ -0.5, { 2.5426577744712517e-5, 0.16666666666666667, 0.41637851556070818, 0.15219979409086506, 0.22210937078793017, 0.99244043806915276 } },
+	{ 0, { 0.0015198726439550864, 0.25, 0.47567988034759129, 0.18747726773371667, 0.23501528853071088, 0.99244881905759412 } },
+	{ 0.3, { 0.0046787163226410558, 0.29849334201033915, 0.5148321320941344, 0.20181702862106465, 0.23982873973004341, 0.99251707073594354 } },
+	{ 0.7, { 0.013247012589940362, 0.37340834444668251, 0.57846159745661652, 0.21135461518442124, 0.24193601297588482, 0.992967628131182 } },
+	{ 0.93, { 0.021425157276281084, 0.44009670829099257, 0.63676070527556228, 0.21185539740294106, 0.24196365222304086, 0.99365830899766739 } },
+	{ 0.99, { 0.022749515662487263, 0.47747329317779395, 0.66972291135206218, 0.21185539858339669, 0.24196365222307301, 0.9937902703698944 } },
+	{ 0.9999, { 0.022750131948179207, 0.49774919045259528, 0.68722842493983609, 0.21185539858339669, 0.24196365222307301, 0.99379033467422386 } },
+	{ 0.999999, { 0.022750131948179207, 0.49977492090220413, 0.6879330505826094, 0.21185539858339669, 0.24196365222307301, 0.99379033467422386 } }
+};
+
+int main() {
+	// Standard Normal CDFs : absolute error against erfc on [-38, 38]
+	double cum_error = 0, cum_fast_error = 0;
+	for (double x = -38; x <= 38; x += 1e-3) {
+		cum_error = max(cum_error, fabs(std_normal_cum(x) - reference_cum(x)));
+		cum_fast_error = max(cum_fast_error, fabs(std_normal_cum_fast(x) - reference_cum(x)));
+	}
+	check("std_normal_cum", cum_error, 1e-15);
+	check("std_normal_cum_fast", cum_fast_error, 7.5e-8);
+
+	// Inverse CDFs : the error of x = inv(p) is (cum(x) - p) / pdf(x), from the round trip through erfc.
+	// p covers (0, 1) uniformly and the tails down to 1e-300.
+	vector<double> p;
+	for (int i = 1; i < 100000; i++)
+		p.push_back(i / 100000.);
+	for (double q = 1e-5; q >= 1e-300; q /= 1.5) {
+		p.push_back(q);
+		p.push_back(1 - q);
+	}
+	double inv_error = 0, inv_fast_error = 0;
+	for (double pi : p) {
+		if (pi >= 1)
+			continue;
+		double x = std_normal_inv(pi);
+		double x_fast = std_normal_inv_fast(pi);
+		double round_trip = (reference_cum(x) - pi) / std_normal_pdf(x);
+		// The round trip only resolves the error of x to a few ulps of p, hence the 1e-14 bound of the accurate inverse.
+		inv_error = max(inv_error, fabs(round_trip) / max(fabs(x), 1e-3));
+		inv_fast_error = max(inv_fast_error, fabs(x_fast - (x - round_trip)) / max(fabs(x), 1e-3));
+	}
+	check("std_normal_inv", inv_error, 1e-14);
+	check("std_normal_inv_fast", inv_fast_error, 1.15e-9);
+
+	// exp_fast : relative error against exp on [-708, 709]
+	double exp_error = 0;
+	for (double x = -708; x <= 709; x += 1.7e-3)
+		exp_error = max(exp_error, fabs(exp_fast(x) / exp(x) - 1));
+	check("exp_fast", exp_error, 3e-16);
+
+	// Array versions : same results as the scalar versions
+	vector<double> x(1001), result(1001);
+	for (int i = 0; i <= 1000; i++)
+		x[i] = -10 + 0.02 * i;
+	double array_error = 0;
+	std_normal_cum(x.data(), result.data(), (int)x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		array_error = max(array_error, fabs(result[i] - std_normal_cum(x[i])));
+	std_normal_cum_fast(x.data(), result.data(), (int)x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		array_error = max(array_error, fabs(result[i] - std_normal_cum_fast(x[i])));
+	exp_fast(x.data(), result.data(), (int)x.size());
+	for (size_t i = 0; i < x.size(); i++)
+		array_error = max(array_error, fabs(result[i] / exp_fast(x[i]) - 1));
+	check("array versions", array_error, 0);
+
+	// Bivariate CDF : absolute error against the reference, on both sides of the switch of BVND at |rho| = 0.925, and the limits rho = -1 and rho = 1
+	double bvn_error = 0, bvn_high_error = 0;
+	for (const BivariateReference& reference : BVN_REFERENCE)
+		for (int i = 0; i < 6; i++) {
+			double error = fabs(bivariate_normal_cum(BVN_POINTS[i][0], BVN_POINTS[i][1], reference.rho) - reference.values[i]);
+			double& worst = fabs(reference.rho) < 0.925 ? bvn_error : bvn_high_error;
+			worst = max(worst, error);
+		}
+	for (double x = -4; x <= 4; x += 0.25)
+		for (double y = -4; y <= 4; y += 0.25) {
+			bvn_high_error = max(bvn_high_error, fabs(bivariate_normal_cum(x, y, 1) - reference_cum(min(x, y))));
+			bvn_high_error = max(bvn_high_error, fabs(bivariate_normal_cum(x, y, -1) - max(reference_cum(x) + reference_cum(y) - 1, 0.)));
+		}
+	check("bivariate_normal_cum", bvn_error, 1e-15);
+	check("bivariate |rho| >= 0.925", bvn_high_error, 5e-15);
+
+	// Gauss-Hermite, exact for the polynomials of degree < 2n : the integrals of exp(-x^2), x^2 exp(-x^2) and x^4 exp(-x^2) are sqrt(pi), sqrt(pi) / 2 and 3 sqrt(pi) / 4
+	double gh_error = 0;
+	for (int n : { 3, 5, 16, 32, 64, 128, 150 }) {
+		vector<double> nodes(n), weights(n);
+		gauss_hermite(n, nodes.data(), weights.data());
+		double m0 = 0, m2 = 0, m4 = 0;
+		for (int i = 0; i < n; i++) {
+			m0 += weights[i];
+			m2 += weights[i] * pow(nodes[i], 2);
+			m4 += weights[i] * pow(nodes[i], 4);
+		}
+		double sqrt_pi = sqrt(3.14159265358979323846);
+		gh_error = max({ gh_error, fabs(m0 / sqrt_pi - 1), fabs(m2 / sqrt_pi - 0.5), fabs(m4 / sqrt_pi - 0.75) });
+		for (int i = 1; i < n; i++)
+			if (!(nodes[i] < nodes[i - 1]))
+				gh_error = HUGE_VAL;
+	}
+	check("gauss_hermite", gh_error, 1e-13);
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cmath>
+#include "Revaluation.h"
+#include "Numerics.h"
+
+using namespace std;
+
+/*
+	The checks of the incremental revaluation, run by CTest : the dirty trades and the cache hits and misses after each market update.
+	Two market objects hold 100 and 50 Vanillas, the first one with two trades per strike : the revaluations run on one thread, so that
+	every count is exact. An unchanged market object leaves its trades clean, a moved one dirties only its own trades, and a market object
+	moved back to a known state is revalued from the cache. The valuations are checked against the BS price, delta and vega.
+	A cache smaller than the book evicts, and the evicted valuations are recomputed when they are looked up.
+*/
+
+int nb_failures = 0;
+
+void check(const char* name, bool ok) {
+
+	/* Prints the check and records a failure. */
+
+	printf("%-56s %s\n", name, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+MarketObject black_market(double spot, double vol) {
+	MarketObject market;
+	market.rate = 0.05;
+	market.spot[0] = spot;
+	market.vol[0] = vol;
+	return market;
+}
+
+TradeRecord vanilla(uint64_t id, double K) {
+	TradeRecord trade;
+	trade.id = id;
+	trade.strike = K;
+	trade.maturity = 1;
+	return trade;
+}
+
+bool black_valuation(const Valuation& value, double S, double K, double sigma) {
+
+	/* The valuation of the Call against the BS price, delta and vega. The Greeks are finite differences : 1e-6 relative. */
+
+	double r = 0.05, T = 1;
+	double d1 = (log(S / K) + (r + sigma * sigma / 2) * T) / (sigma * sqrt(T));
+	double price = S * std_normal_cum(d1) - K * exp(-r * T) * std_normal_cum(d1 - sigma * sqrt(T));
+	double vega = S * std_normal_pdf(d1) * sqrt(T);
+	return value.status == TRADE_OK && fabs(value.price - price) <= 1e-10 * price && fabs(value.delta - std_normal_cum(d1)) <= 1e-6
+		&& fabs(value.vega - vega) <= 1e-6 * vega;
+}
+
+bool stats_moved(Revaluation& book, CacheStats& previous, uint64_t hits, uint64_t misses) {
+
+	/* True when the cache counted "hits" and "misses" since "previous", which is updated. */
+
+	CacheStats stats = book.getCacheStats();
+	bool ok = stats.hits - previous.hits == hits && stats.misses - previous.misses == misses;
+	previous = stats;
+	return ok;
+}
+
+int main() {
+	Revaluation book;
+	MarketObject market_a = black_market(100, 0.3), market_b = black_market(50, 0.2);
+	book.setMarket("A", market_a);
+	book.setMarket("B", market_b);
+	bool added = true;
+	for (int i = 0; i < 100; i++)
+		added = added && book.addTrade(vanilla(i, 80 + i % 50), "A");
+	for (int i = 100; i < 150; i++)
+		added = added && book.addTrade(vanilla(i, i - 70), "B");
+	check("trades added", added && book.getNbTrades() == 150);
+	check("unknown market object refused", !book.addTrade(vanilla(1000, 100), "C") && book.getNbTrades() == 150);
+
+	// First revaluation : the second trade of each strike of A is a hit
+	CacheStats stats;
+	check("new trades dirty", book.getNbDirty() == 150);
+	check("first revaluation : 100 misses, 50 shared inputs", book.revalue(1) == 150 && stats_moved(book, stats, 50, 100));
+	check("clean book : nothing revalued", book.getNbDirty() == 0 && book.revalue(1) == 0 && stats_moved(book, stats, 0, 0));
+
+	Valuation value;
+	check("valuation of a clean trade is a hit", book.getValuation(7, value) && stats_moved(book, stats, 1, 0));
+	check("price, delta and vega of A", black_valuation(value, 100, 87, 0.3));
+	check("unknown trade", !book.getValuation(1000, value));
+
+	// Market updates
+	book.setMarket("A", market_a);
+	check("unchanged market object : no dirty trade", book.getNbDirty() == 0);
+	MarketObject moved_a = black_market(101, 0.3);
+	book.setMarket("A", moved_a);
+	check("moved market object : its 100 trades dirty", book.getNbDirty() == 100);
+	check("revaluation of the moved trades", book.revalue(1) == 100 && stats_moved(book, stats, 50, 50));
+	book.getValuation(7, value);
+	check("moved price, delta and vega of A", black_valuation(value, 101, 87, 0.3));
+	book.getValuation(120, value);
+	check("trades of B unchanged", black_valuation(value, 50, 50, 0.2));
+	check("lookups of clean trades are hits", stats_moved(book, stats, 2, 0));
+	book.setMarket("A", market_a);
+	check("market object moved back : revalued from the cache", book.revalue(1) == 100 && stats_moved(book, stats, 100, 0));
+	book.getValuation(7, value);
+	check("price, delta and vega of A moved back", black_valuation(value, 100, 87, 0.3));
+
+	// Trade updates
+	book.addTrade(vanilla(7, 95), "A");
+	check("replaced trade dirty", book.getNbDirty() == 1 && book.getNbTrades() == 150);
+	book.getValuation(7, value);
+	check("replaced trade valued with its new terms", black_valuation(value, 100, 95, 0.3));
+	book.removeTrade(7);
+	check("removed trade", book.getNbTrades() == 149 && !book.getValuation(7, value));
+	TradeRecord invalid = vanilla(200, -1);
+	book.addTrade(invalid, "A");
+	check("invalid trade valued with its status", book.getValuation(200, value) && value.status == TRADE_INVALID_CONTRACT);
+
+	// Cache smaller than the book : 32 valuations for 200 distinct trades
+	Revaluation small(32);
+	small.setMarket("A", market_a);
+	for (int i = 0; i < 200; i++)
+		small.addTrade(vanilla(i, 50 + i * 0.5), "A");
+	small.revalue(4);
+	CacheStats small_stats = small.getCacheStats();
+	check("small cache evicts", small_stats.evictions >= 168 && small_stats.size <= 32);
+	check("evicted valuation recomputed", small.getValuation(0, value) && black_valuation(value, 100, 50, 0.3));
+
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include "Schedule.h"
+
+using namespace std;
+
+/*
+	The checks of the Schedules, run by CTest : the merged time grid of the steps and fixing dates, and the cache.
+	The cache must return the same Schedule for the same grid, the one-step grids of the Vanillas included, and a new Schedule
+	for another maturity. A stream of new maturities must evict the least recently used grids, not the recently used ones.
+*/
+
+int nb_failures = 0;
+
+void check(const char* name, bool ok) {
+
+	/* Prints the check and records a failure. */
+
+	printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+int main() {
+	// 4 steps and 3 fixings on T = 1.5 : the dates 1/4, 1/3, 1/2, 2/3, 3/4 and 1 of the maturity
+	Schedule merged(1.5, 4, 3);
+	const double dates[] = { 0.25, 1. / 3, 0.5, 2. / 3, 0.75, 1 };
+	const bool fixings[] = { false, true, false, true, false, true };
+	bool ok = merged.size() == 6;
+	double t = 0;
+	for (int i = 0; ok && i < merged.size(); i++) {
+		t += merged.getDt(i);
+		ok = fabs(t - 1.5 * dates[i]) < 1e-15 && fabs(merged.getSqrtDt(i) - sqrt(merged.getDt(i))) < 1e-15 && merged.isFixing(i) == fixings[i];
+	}
+	check("merged steps and fixings", ok);
+
+	// Common dates are merged : 6 steps and 3 fixings share every fixing date
+	Schedule common(1, 6, 3);
+	check("common dates merged", common.size() == 6 && common.isFixing(1) && common.isFixing(3) && common.isFixing(5) && !common.isFixing(4));
+
+	shared_ptr<const Schedule> one_step = Schedule::get(0.75, 1, 1);
+	check("one-step grid cached", one_step == Schedule::get(0.75, 1, 1));
+	check("one-step grid per maturity", one_step != Schedule::get(0.5, 1, 1) && Schedule::get(0.5, 1, 1)->getMaturity() == 0.5);
+	shared_ptr<const Schedule> grid = Schedule::get(1, 50, 12);
+	check("grid cached", grid == Schedule::get(1, 50, 12) && grid->getNbSteps() == 50 && grid->getFreq() == 12);
+
+	// A stream of new maturities, while the grid above stays in use
+	for (int i = 1; i <= 100000; i++) {
+		Schedule::get(1 + i * 1e-6, 1, 1);
+		if (i % 1000 == 0)
+			Schedule::get(1, 50, 12);
+	}
+	check("recently used grid kept", grid == Schedule::get(1, 50, 12));
+	check("least recently used grid evicted", one_step != Schedule::get(0.75, 1, 1));
+
+	// A grid larger than a quarter of the cache is built for the caller only
+	shared_ptr<const Schedule> large = Schedule::get(1, 300000, 1);
+	check("large grid not cached", large != Schedule::get(1, 300000, 1) && large->size() == 300000);
+
+	return nb_failures == 0 ? 0 : 1;
+}
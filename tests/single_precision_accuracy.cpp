@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "MonteCarlo.h"
+
+using namespace std;
+
+/*
+	The accuracy checks of the single precision Monte-Carlo engine, run by CTest.
+	Each price is the mean of NB_BATCHES independent Monte-Carlo prices, and its standard error is estimated from the spread of the batches.
+	The single and double precision prices must agree within 5 standard errors, and with the closed form when it is exact (Vanillas).
+	The Asian and Basket closed forms are moment-matching approximations : their distance to the two engines is printed, not checked.
+	The paths themselves are compared on the same normals : the float simulation must stay within 1e-5 of the double one, relatively.
+*/
+
+const int NB_BATCHES = 20;
+int nb_failures = 0;
+
+struct Estimate {
+	double price = 0;
+	double se = 0;
+};
+
+template <typename Model> Estimate estimate(MonteCarlo& mc, Model* model, Option* opt) {
+
+	/* Mean and standard error of NB_BATCHES Monte-Carlo prices. */
+
+	double sum = 0, sum2 = 0;
+	for (int b = 0; b < NB_BATCHES; b++) {
+		double p = mc.price(model, opt);
+		sum += p;
+		sum2 += p * p;
+	}
+	Estimate e;
+	e.price = sum / NB_BATCHES;
+	e.se = sqrt(max(sum2 / NB_BATCHES - e.price * e.price, 0.) / (NB_BATCHES - 1));
+	return e;
+}
+
+template <typename Model> void check_prices(const char* name, Model* model, Option* opt, double nb_paths, double nb_steps, bool exact_closed_form) {
+	/*
+		Single against double precision prices, and against the closed form when it is exact.
+		The gap is measured in standard errors of the difference.
+	*/
+	MonteCarlo mc_double(nb_paths, nb_steps), mc_single(nb_paths, nb_steps);
+	mc_single.setSinglePrecision(true);
+	Estimate d = estimate(mc_double, model, opt);
+	Estimate s = estimate(mc_single, model, opt);
+	double closed_form = model->price(opt);
+
+	double gap = fabs(s.price - d.price) / sqrt(d.se * d.se + s.se * s.se);
+	bool ok = gap <= 5;
+	if (exact_closed_form)
+		ok = ok && fabs(s.price - closed_form) <= 5 * s.se && fabs(d.price - closed_form) <= 5 * d.se;
+	printf("%-8s single %.4f (se %.4f)  double %.4f (se %.4f)  closed form %.4f  single - double %.2f se  %s\n",
+		name, s.price, s.se, d.price, d.se, closed_form, gap, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+void check_paths() {
+
+	/* The same normals stepped in float and in double over 252 steps, for 512 paths. */
+
+	BlackVanilla model(0.05, 100, 0.3);
+	int n = 512, steps = 252;
+	double dt = 1. / steps;
+	vector<float> S_single(n, 100.f), normals(n);
+	vector<double> S_double(n, 100.);
+	double error = 0;
+	for (int i = 0; i < steps; i++) {
+		norm_variables(normals.data(), n);
+		model.simulation(S_single.data(), normals.data(), n, dt, sqrt(dt));
+		for (int j = 0; j < n; j++) {
+			S_double[j] = model.simulation(S_double[j], dt, sqrt(dt), normals[j]);
+			error = max(error, fabs(S_single[j] / S_double[j] - 1));
+		}
+	}
+	bool ok = error <= 1e-5;
+	printf("%-8s max relative difference of the float paths %.2e  %s\n", "paths", error, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+int main() {
+	BlackVanilla vanilla(0.05, 100, 0.3);
+	VanillaOption call_vanilla(105, 1, 1);
+	check_prices("Vanilla", &vanilla, &call_vanilla, 50000, 1, true);
+
+	BlackAsian asian(0.05, 100, 0.3);
+	AsianOption call_asian(105, 1, 1, 4);
+	check_prices("Asian", &asian, &call_asian, 20000, 10, false);
+
+	BlackBasket basket(0.05, 3, { 100, 105, 95 }, { 0.35, 0.3, 0.4 }, { { 1, -0.6, 0.3 }, { -0.6, 1, -0.2 }, { 0.3, -0.2, 1 } });
+	BasketOption call_basket(100, 1, 1, 3);
+	check_prices("Basket", &basket, &call_basket, 50000, 1, false);
+
+	check_paths();
+	return nb_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "MonteCarlo.h"
+#include "Numerics.h"
+
+using namespace std;
+
+/*
+	The checks of the Spread quadrature pricer, run by CTest.
+	A zero strike Spread is an exchange option : the quadrature must give Margrabe's price, as Kirk's approximation does. For the other
+	strikes, negative correlations included, the quadrature must have converged (32 nodes against 64, and against 128 for correlations
+	close to 1), meet the Call-Put parity, stay within 2% of Kirk's approximation, whose bias grows with the strike and the correlation,
+	and within 5 standard errors of the Monte-Carlo price, the mean of NB_BATCHES prices.
+	The strikes priced together must give the prices of the strikes priced one by one.
+*/
+
+const int NB_BATCHES = 20;
+int nb_failures = 0;
+
+void check(const char* name, double error, double bound) {
+
+	/* Prints the error against its bound and records a failure when it is larger. */
+
+	bool ok = error <= bound;
+	printf("%-56s error %.3g  bound %.2g  %s\n", name, error, bound, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+double margrabe(double S1, double S2, double sigma1, double sigma2, double rho, double T) {
+
+	/* Exchange option max(S1_T - S2_T, 0). */
+
+	double vol = sqrt(sigma1 * sigma1 + sigma2 * sigma2 - 2 * rho * sigma1 * sigma2) * sqrt(T);
+	double d1 = (log(S1 / S2) + vol * vol / 2) / vol;
+	return S1 * std_normal_cum(d1) - S2 * std_normal_cum(d1 - vol);
+}
+
+int main() {
+	double r = 0.05, S1 = 100, S2 = 95, sigma1 = 0.3, sigma2 = 0.25, T = 1;
+	char name[96];
+
+	for (double rho : { -0.9, -0.5, 0., 0.5, 0.9 }) {
+		BlackSpread spread(r, { S1, S2 }, { sigma1, sigma2 }, { { 1, rho }, { rho, 1 } });
+		double exchange = margrabe(S1, S2, sigma1, sigma2, rho, T);
+		snprintf(name, sizeof(name), "zero strike, Margrabe, rho = %g", rho);
+		check(name, fabs(spread.priceQuadrature(0, T, 1) / exchange - 1), 1e-12);
+		snprintf(name, sizeof(name), "zero strike, Kirk, rho = %g", rho);
+		check(name, fabs(spread.price(0, T, 1) / exchange - 1), 1e-12);
+
+		double converged = 0, parity = 0, kirk = 0;
+		for (double K : { -10., 5., 20. }) {
+			double call = spread.priceQuadrature(K, T, 1);
+			converged = max(converged, fabs(call - spread.priceQuadrature(K, T, 1, 64)));
+			parity = max(parity, fabs(call - spread.priceQuadrature(K, T, -1) - (S1 - S2 - K * exp(-r * T))));
+			kirk = max(kirk, fabs(spread.price(K, T, 1) / call - 1));
+		}
+		snprintf(name, sizeof(name), "32 nodes against 64, rho = %g", rho);
+		check(name, converged, 1e-11);
+		snprintf(name, sizeof(name), "Call-Put parity, rho = %g", rho);
+		check(name, parity, 1e-11);
+		snprintf(name, sizeof(name), "Kirk against the quadrature (relative), rho = %g", rho);
+		check(name, kirk, 0.02);
+	}
+
+	// Correlations close to 1
+	for (double rho : { -0.99, 0.99 }) {
+		BlackSpread spread(r, { S1, S2 }, { sigma1, sigma2 }, { { 1, rho }, { rho, 1 } });
+		double converged = 0;
+		for (double K : { -10., 5., 20. })
+			converged = max(converged, fabs(spread.priceQuadrature(K, T, 1) - spread.priceQuadrature(K, T, 1, 128)));
+		snprintf(name, sizeof(name), "32 nodes against 128, rho = %g", rho);
+		check(name, converged, 1e-10);
+		snprintf(name, sizeof(name), "zero strike, Margrabe, rho = %g", rho);
+		check(name, fabs(spread.priceQuadrature(0, T, 1) / margrabe(S1, S2, sigma1, sigma2, rho, T) - 1), 1e-12);
+	}
+
+	// Monte-Carlo
+	BlackSpread spread(r, { S1, S2 }, { sigma1, sigma2 }, { { 1, 0.5 }, { 0.5, 1 } });
+	MonteCarlo mc(20000, 1);
+	for (int phi : { 1, -1 }) {
+		SpreadOption opt(5, T, phi);
+		double sum = 0, sum2 = 0;
+		for (int b = 0; b < NB_BATCHES; b++) {
+			double p = mc.price(&spread, &opt);
+			sum += p;
+			sum2 += p * p;
+		}
+		double mean = sum / NB_BATCHES;
+		double se = sqrt(max(sum2 / NB_BATCHES - mean * mean, 0.) / (NB_BATCHES - 1));
+		snprintf(name, sizeof(name), "Monte-Carlo against the quadrature, %s", phi == 1 ? "Call" : "Put");
+		check(name, fabs(mean - spread.priceQuadrature(&opt)), 5 * se);
+	}
+
+	// Strikes priced together
+	vector<double> strikes = { -20, -5, 0, 2.5, 5, 10, 40 }, prices(strikes.size());
+	spread.priceQuadrature(strikes.data(), prices.data(), (int)strikes.size(), T, 1);
+	double batch_error = 0;
+	for (size_t i = 0; i < strikes.size(); i++)
+		batch_error = max(batch_error, fabs(prices[i] - spread.priceQuadrature(strikes[i], T, 1)));
+	check("strikes priced together", batch_error, 0);
+
+	return nb_failures == 0 ? 0 : 1;
+}
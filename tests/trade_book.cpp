@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "TradeBook.h"
+
+using namespace std;
+
+/*
+	The checks of the columnar books, run by CTest : a book written by "TradeBookWriter" must read back through the mapping with the
+	same columns and the deduplicated model table, and its mapped pricing must give the prices of "priceTrade", written in a result
+	file that reads back the same once reopened. The trades that a book cannot hold are refused with their status.
+	The damaged files must be refused when they are opened, and an invalid Heston model in a book must give error rows, not end the process.
+	The files are written in the working directory of the test.
+*/
+
+const char* BOOK_PATH = "trade_book_test.book";
+const char* RESULT_PATH = "trade_book_test.result";
+int nb_failures = 0;
+
+void check(const char* name, bool ok) {
+
+	/* Prints the check and records a failure. */
+
+	printf("%-48s %s\n", name, ok ? "ok" : "FAILED");
+	nb_failures += !ok;
+}
+
+TradeRecord trade(uint64_t id, int32_t option, int32_t phi, double K, double T, int model_choice) {
+
+	/* Analytical trade on one of three models : two Black models, and a Heston model. */
+
+	TradeRecord t;
+	t.id = id;
+	t.option = option;
+	t.phi = phi;
+	t.strike = K;
+	t.maturity = T;
+	t.rate = 0.05;
+	t.spot[0] = model_choice == 1 ? 110 : 100;
+	t.vol[0] = 0.3;
+	if (model_choice == 2) {
+		t.model = MODEL_HESTON;
+		t.v0 = 0.04, t.kappa = 1.5, t.theta = 0.04, t.xi = 0.5, t.rho = -0.7;
+	}
+	return t;
+}
+
+int main() {
+	vector<TradeRecord> trades;
+	for (int i = 0; i < 1400; i++) {
+		int kind = i % 7;
+		double K = 80 + i % 41;
+		double T = 0.25 + (i % 8) * 0.25;
+		TradeRecord t;
+		if (kind == 0)
+			t = trade(i, OPTION_VANILLA, i % 2 ? 1 : -1, K, T, i % 3);
+		else if (kind == 1)
+			t = trade(i, OPTION_VANILLA, 1, K, T, 2);
+		else if (kind == 2)
+			t = trade(i, OPTION_DIGITAL, -1, K, T, i % 2);
+		else if (kind == 3) {
+			t = trade(i, OPTION_ASIAN, 1, K, T, i % 2);
+			t.freq = 1 + i % 12;
+		}
+		else {
+			// The four Barrier types
+			int barrier_type = (i / 7) % BARRIER_COUNT;
+			bool up = barrier_type == BARRIER_UP_OUT || barrier_type == BARRIER_UP_IN;
+			t = trade(i, OPTION_BARRIER, up ? 1 : -1, K, T, i % 2);
+			t.barrier_type = barrier_type;
+			t.barrier = up ? K + 30 : K - 30;
+		}
+		trades.push_back(t);
+	}
+
+	// The trades a book cannot hold
+	TradeRecord monte_carlo = trade(1, OPTION_VANILLA, 1, 100, 1, 0), monitored = trade(2, OPTION_BARRIER, 1, 100, 1, 0), invalid = trade(3, OPTION_VANILLA, 1, 100, 1, 0);
+	monte_carlo.method = METHOD_MONTECARLO;
+	monitored.barrier = 130;
+	monitored.monitored = 1;
+	invalid.vol[0] = -0.3;
+
+	{
+		TradeBookWriter writer(BOOK_PATH);
+		bool added = true;
+		for (const TradeRecord& t : trades)
+			added = added && writer.add(t) == TRADE_OK;
+		check("trades added", added);
+		check("Monte-Carlo and monitored trades refused", writer.add(monte_carlo) == TRADE_UNSUPPORTED && writer.add(monitored) == TRADE_UNSUPPORTED);
+		check("invalid trade refused", writer.add(invalid) == TRADE_INVALID_MODEL);
+		check("book written, models deduplicated", writer.close() && writer.getNbTrades() == trades.size() && writer.getNbModels() == 3);
+	}
+
+	// Columns of the mapped book
+	TradeBook book(BOOK_PATH);
+	check("book mapped", book.isOpen() && book.getNbTrades() == trades.size() && book.getNbModels() == 3);
+	if (!book.isOpen())
+		return 1;
+	bool columns = true;
+	for (size_t i = 0; i < trades.size(); i++) {
+		const TradeRecord& t = trades[i];
+		const BookModel& model = book.getModels()[book.getModelIndices()[i]];
+		uint8_t type = t.option == OPTION_VANILLA ? BOOK_VANILLA : t.option == OPTION_DIGITAL ? BOOK_DIGITAL : t.option == OPTION_ASIAN ? BOOK_ASIAN : BOOK_UP_OUT + t.barrier_type;
+		columns = columns && book.getIds()[i] == t.id && book.getStrikes()[i] == t.strike && book.getMaturities()[i] == t.maturity;
+		columns = columns && book.getBarriers()[i] == t.barrier && book.getFreqs()[i] == t.freq && book.getPhis()[i] == t.phi && book.getTypes()[i] == type;
+		columns = columns && model.model == t.model && model.spot == t.spot[0] && model.rate == t.rate;
+		columns = columns && (t.model == MODEL_HESTON ? model.xi == t.xi && model.rho == t.rho : model.vol == t.vol[0]);
+	}
+	check("columns read back", columns);
+
+	// Mapped pricing, and the result file reopened
+	{
+		ResultBook results(RESULT_PATH, book.getNbTrades());
+		check("result file created", results.isOpen());
+		if (!results.isOpen())
+			return 1;
+		check("book priced without errors", book.price(results, 3) == 0 && results.flush());
+	}
+	ResultBook results(RESULT_PATH);
+	check("result file reopened", results.isOpen() && results.getNbTrades() == trades.size());
+	if (!results.isOpen())
+		return 1;
+	MonteCarlo mc;
+	bool prices = true;
+	for (size_t i = 0; i < trades.size(); i++) {
+		double price = 0;
+		prices = prices && priceTrade(trades[i], mc, price) == TRADE_OK && results.getStatus()[i] == TRADE_OK;
+		prices = prices && fabs(results.getPrices()[i] - price) <= 1e-12 * max(1., fabs(price));
+	}
+	check("mapped prices equal priceTrade", prices);
+
+	// Damaged files : wrong magic, and a truncated book
+	{
+		ofstream(RESULT_PATH, ios::binary | ios::trunc) << "not a book, not a result file";
+	}
+	check("wrong magic refused", !TradeBook(RESULT_PATH).isOpen() && !ResultBook(RESULT_PATH).isOpen());
+	{
+		ifstream in(BOOK_PATH, ios::binary);
+		string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		ofstream(RESULT_PATH, ios::binary | ios::trunc).write(content.data(), content.size() / 2);
+	}
+	TradeBook truncated(RESULT_PATH);
+	check("truncated book refused", !truncated.isOpen() && !truncated.getError().empty());
+
+	// Invalid Heston model written in the book : xi = 0 in the model table
+	uint32_t heston_row = book.getModelIndices()[1];
+	{
+		ifstream in(BOOK_PATH, ios::binary);
+		string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		const BookHeader* header = (const BookHeader*)content.data();
+		double zero = 0;
+		memcpy(&content[header->modelsOffset + heston_row * sizeof(BookModel) + offsetof(BookModel, xi)], &zero, sizeof(zero));
+		ofstream(RESULT_PATH, ios::binary | ios::trunc).write(content.data(), content.size());
+	}
+	TradeBook damaged(RESULT_PATH);
+	uint64_t heston_trades = 0;
+	for (size_t i = 0; i < trades.size(); i++)
+		heston_trades += trades[i].model == MODEL_HESTON;
+	bool heston_errors = damaged.isOpen();
+	if (heston_errors) {
+		ResultBook damaged_results("trade_book_test.damaged", damaged.getNbTrades());
+		heston_errors = damaged.price(damaged_results, 2) == heston_trades;
+		for (size_t i = 0; heston_errors && i < trades.size(); i++)
+			heston_errors = damaged_results.getStatus()[i] == (trades[i].model == MODEL_HESTON ? TRADE_INVALID_MODEL : TRADE_OK);
+	}
+	check("invalid Heston model gives error rows", heston_errors);
+
+	remove(BOOK_PATH);
+	remove(RESULT_PATH);
+	remove("trade_book_test.damaged");
+	return nb_failures == 0 ? 0 : 1;
+}